@@ -0,0 +1,161 @@
+/*=========================================================================
+
+  Name:        BackgroundWriter.cpp
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+  Description: Writes a copy of a data set to a VTK XML file (.vtu or
+               .vtp) with raw appended binary data in a background
+               thread.
+
+=========================================================================*/
+
+
+#include "BackgroundWriter.h"
+
+#include <vtkDataSet.h>
+#include <vtkMutexLock.h>
+#include <vtkPolyData.h>
+#include <vtkUnstructuredGrid.h>
+#include <vtkXMLPolyDataWriter.h>
+#include <vtkXMLUnstructuredGridWriter.h>
+#include <vtkZLibDataCompressor.h>
+
+#include <iostream>
+
+
+BackgroundWriter::BackgroundWriter() {
+    threader = vtkMultiThreader::New();
+    threadId = -1;
+    lock = vtkMutexLock::New();
+
+    copy = NULL;
+    writer = NULL;
+    done = false;
+    success = false;
+}
+
+BackgroundWriter::~BackgroundWriter() {
+    Finish();
+
+    threader->Delete();
+    lock->Delete();
+}
+
+
+bool BackgroundWriter::Start(vtkDataSet* data, const char* fileName, bool compress) {
+    Finish();
+
+    if (data == NULL) return false;
+
+    name = fileName;
+    bool vtp = name.size() >= 4 && name.substr(name.size() - 4) == ".vtp";
+
+    if (vtp && !vtkPolyData::SafeDownCast(data)) {
+        std::cout << "Can only write poly data to " << fileName << std::endl;
+        return false;
+    }
+    if (!vtp && !vtkUnstructuredGrid::SafeDownCast(data)) {
+        std::cout << "Can only write unstructured grids to " << fileName << std::endl;
+        return false;
+    }
+
+    // Deep copy, as the pipeline can update its output while writing, and
+    // reference counts on shared arrays are not thread safe
+    copy = data->NewInstance();
+    copy->DeepCopy(data);
+
+    if (vtp) {
+        vtkXMLPolyDataWriter* polyDataWriter = vtkXMLPolyDataWriter::New();
+        polyDataWriter->SetInput(vtkPolyData::SafeDownCast(copy));
+        writer = polyDataWriter;
+    }
+    else {
+        vtkXMLUnstructuredGridWriter* gridWriter = vtkXMLUnstructuredGridWriter::New();
+        gridWriter->SetInput(vtkUnstructuredGrid::SafeDownCast(copy));
+        writer = gridWriter;
+    }
+
+    writer->SetFileName(fileName);
+    writer->SetDataModeToAppended();
+    writer->EncodeAppendedDataOff();
+
+    if (compress) {
+        vtkZLibDataCompressor* compressor = vtkZLibDataCompressor::New();
+        compressor->SetCompressionLevel(1);
+        writer->SetCompressor(compressor);
+        compressor->Delete();
+    }
+    else {
+        writer->SetCompressor(NULL);
+    }
+
+    done = false;
+    success = false;
+
+    threadId = threader->SpawnThread(ThreadFunction, this);
+
+    return true;
+}
+
+
+void BackgroundWriter::Finish() {
+    if (threadId < 0) return;
+
+    threader->TerminateThread(threadId);
+    threadId = -1;
+
+    writer->Delete();
+    writer = NULL;
+
+    copy->Delete();
+    copy = NULL;
+
+    if (!success) {
+        std::cout << "Error writing " << name << std::endl;
+    }
+}
+
+
+bool BackgroundWriter::Poll() {
+    if (threadId < 0) return false;
+
+    lock->Lock();
+    bool finished = done;
+    lock->Unlock();
+
+    if (!finished) return false;
+
+    // Thread has finished, so this just cleans up
+    Finish();
+
+    return true;
+}
+
+
+bool BackgroundWriter::IsWriting() {
+    return threadId >= 0;
+}
+
+
+VTK_THREAD_RETURN_TYPE BackgroundWriter::ThreadFunction(void* arg) {
+    vtkMultiThreader::ThreadInfo* info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+    BackgroundWriter* self = static_cast<BackgroundWriter*>(info->UserData);
+
+    bool success = self->writer->Write() == 1;
+
+    self->lock->Lock();
+    self->success = success;
+    self->done = true;
+    self->lock->Unlock();
+
+    return VTK_THREAD_RETURN_VALUE;
+}
@@ -0,0 +1,69 @@
+/*=========================================================================
+
+  Name:        BackgroundWriter.h
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+  Description: Writes a copy of a data set to a VTK XML file (.vtu or
+               .vtp) with raw appended binary data in a background
+               thread.
+
+=========================================================================*/
+
+
+#ifndef BACKGROUNDWRITER_H
+#define BACKGROUNDWRITER_H
+
+
+#include <vtkMultiThreader.h>
+
+#include <string>
+
+class vtkDataSet;
+class vtkMutexLock;
+class vtkXMLWriter;
+
+
+class BackgroundWriter {
+public:
+    BackgroundWriter();
+    ~BackgroundWriter();
+
+    // Copy the data and start writing it.  .vtp files need poly data,
+    // anything else is written as an unstructured grid.  Compression uses
+    // the fastest zlib level.  Waits for any previous write to finish.
+    bool Start(vtkDataSet* data, const char* fileName, bool compress);
+
+    // Wait for the current write to finish
+    void Finish();
+
+    // Returns true once when a write has finished.  Call from the main
+    // thread, e.g. from a timer.
+    bool Poll();
+
+    bool IsWriting();
+
+protected:
+    vtkMultiThreader* threader;
+    int threadId;
+    vtkMutexLock* lock;
+
+    vtkDataSet* copy;
+    vtkXMLWriter* writer;
+    std::string name;
+    bool done;
+    bool success;
+
+    static VTK_THREAD_RETURN_TYPE ThreadFunction(void* arg);
+};
+
+
+#endif
@@ -0,0 +1,355 @@
+/*=========================================================================
+
+  Name:        BoxClipper.cpp
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+  Description: Clips triangles and tetrahedra against a clipping box
+               without going through the VTK pipeline.  Used for
+               evaluating many clipping boxes in one pass over the data.
+
+=========================================================================*/
+
+
+#include "BoxClipper.h"
+
+#include "VTKPipeline.h"
+
+#include <vtkMath.h>
+
+#include <math.h>
+
+
+BoxClipper::BoxClipper() {
+    double c[3] = { 0.0, 0.0, 0.0 };
+    double s[3] = { 1.0, 1.0, 1.0 };
+    SetBox(c, s, 0.0, VTKPipeline::AccurateClip);
+}
+
+
+void BoxClipper::SetBox(const double boxCenter[3], const double boxSize[3], double rotation, int type) {
+    for (int i = 0; i < 3; i++) {
+        center[i] = boxCenter[i];
+        size[i] = boxSize[i];
+    }
+
+    // Same as the inverse transform in VTKPipeline::UpdateClipping()
+    double theta = vtkMath::RadiansFromDegrees(rotation);
+    cosTheta = cos(theta);
+    sinTheta = sin(theta);
+
+    clipType = type;
+}
+
+
+void BoxClipper::GetBounds(double bounds[6]) {
+    // Rotate the corners back into world space
+    double hx = size[0] * 0.5;
+    double hy = size[1] * 0.5;
+
+    double ex = fabs(cosTheta) * hx + fabs(sinTheta) * hy;
+    double ey = fabs(sinTheta) * hx + fabs(cosTheta) * hy;
+
+    bounds[0] = center[0] - ex;
+    bounds[1] = center[0] + ex;
+    bounds[2] = center[1] - ey;
+    bounds[3] = center[1] + ey;
+    bounds[4] = center[2] - size[2] * 0.5;
+    bounds[5] = center[2] + size[2] * 0.5;
+}
+
+
+void BoxClipper::Clip(const Simplex& in, std::vector<Simplex>& out) {
+    if (clipType == VTKPipeline::CutX ||
+        clipType == VTKPipeline::CutY ||
+        clipType == VTKPipeline::CutZ) {
+        // Cutting a triangle produces lines, which have no area
+        if (in.numberOfPoints != 4) return;
+
+        buffer1.clear();
+        Cut(in, buffer1);
+    }
+    else {
+        // Check for the simplex being completely inside or outside
+        bool inside = true;
+        for (int plane = 0; plane < 6; plane++) {
+            int numInside = 0;
+            for (int i = 0; i < in.numberOfPoints; i++) {
+                double b[3];
+                ToBox(in.p[i].x, b);
+                if (PlaneDistance(b, plane) >= 0.0) numInside++;
+            }
+
+            if (numInside == 0) return;
+            if (numInside < in.numberOfPoints) inside = false;
+        }
+
+        if (inside) {
+            out.push_back(in);
+            return;
+        }
+
+        // Like vtkExtractGeometry, only keep cells completely inside
+        if (clipType == VTKPipeline::Extract) return;
+
+        buffer1.clear();
+        buffer1.push_back(in);
+    }
+
+    // Clip against each plane in turn, like the daisy-chained clip filters
+    for (int plane = 0; plane < 6 && buffer1.size() > 0; plane++) {
+        ClipPlane(buffer1, buffer2, plane);
+        buffer1.swap(buffer2);
+    }
+
+    out.insert(out.end(), buffer1.begin(), buffer1.end());
+}
+
+
+double BoxClipper::ComputeMeasure(const Simplex& s) {
+    double a[3], b[3];
+    for (int i = 0; i < 3; i++) {
+        a[i] = s.p[1].x[i] - s.p[0].x[i];
+        b[i] = s.p[2].x[i] - s.p[0].x[i];
+    }
+
+    double n[3];
+    vtkMath::Cross(a, b, n);
+
+    if (s.numberOfPoints == 3) {
+        return 0.5 * vtkMath::Norm(n);
+    }
+
+    double c[3];
+    for (int i = 0; i < 3; i++) {
+        c[i] = s.p[3].x[i] - s.p[0].x[i];
+    }
+
+    return fabs(vtkMath::Dot(n, c)) / 6.0;
+}
+
+void BoxClipper::ComputeCenter(const Simplex& s, double c[3]) {
+    for (int i = 0; i < 3; i++) {
+        c[i] = 0.0;
+        for (int j = 0; j < s.numberOfPoints; j++) {
+            c[i] += s.p[j].x[i];
+        }
+        c[i] /= s.numberOfPoints;
+    }
+}
+
+
+void BoxClipper::ToBox(const double x[3], double b[3]) {
+    double qx = x[0] - center[0];
+    double qy = x[1] - center[1];
+    double qz = x[2] - center[2];
+
+    b[0] = (cosTheta * qx - sinTheta * qy) / size[0];
+    b[1] = (sinTheta * qx + cosTheta * qy) / size[1];
+    b[2] = qz / size[2];
+}
+
+double BoxClipper::PlaneDistance(const double b[3], int plane) {
+    // Same order as the planes in the VTKPipeline constructor
+    switch (plane) {
+        case 0: return b[0] + 0.5;
+        case 1: return 0.5 - b[0];
+        case 2: return b[1] + 0.5;
+        case 3: return 0.5 - b[1];
+        case 4: return b[2] + 0.5;
+        case 5: return 0.5 - b[2];
+    }
+
+    return 0.0;
+}
+
+
+void BoxClipper::ClipPlane(const std::vector<Simplex>& in, std::vector<Simplex>& out, int plane) {
+    out.clear();
+
+    for (int s = 0; s < (int)in.size(); s++) {
+        const Simplex& simplex = in[s];
+        int n = simplex.numberOfPoints;
+
+        // Sort vertices into inside and outside
+        double d[4];
+        int inside[4];
+        int outside[4];
+        int numInside = 0;
+        int numOutside = 0;
+        for (int i = 0; i < n; i++) {
+            double b[3];
+            ToBox(simplex.p[i].x, b);
+            d[i] = PlaneDistance(b, plane);
+
+            if (d[i] >= 0.0) inside[numInside++] = i;
+            else outside[numOutside++] = i;
+        }
+
+        if (numInside == 0) continue;
+
+        if (numOutside == 0) {
+            out.push_back(simplex);
+            continue;
+        }
+
+        // Intersection of the edge between inside vertex i and outside vertex j
+        #define EDGE(i, j, v) Interpolate(simplex.p[inside[i]], simplex.p[outside[j]], \
+                                          d[inside[i]] / (d[inside[i]] - d[outside[j]]), v)
+
+        const SimplexVertex* a = &simplex.p[inside[0]];
+
+        Simplex t;
+        t.numberOfPoints = n;
+
+        if (n == 3) {
+            if (numInside == 1) {
+                // Smaller triangle
+                t.p[0] = *a;
+                EDGE(0, 0, t.p[1]);
+                EDGE(0, 1, t.p[2]);
+                out.push_back(t);
+            }
+            else {
+                // Quad, split into two triangles
+                const SimplexVertex* b = &simplex.p[inside[1]];
+                SimplexVertex ac, bc;
+                EDGE(0, 0, ac);
+                EDGE(1, 0, bc);
+
+                t.p[0] = *a; t.p[1] = *b; t.p[2] = bc;
+                out.push_back(t);
+
+                t.p[0] = *a; t.p[1] = bc; t.p[2] = ac;
+                out.push_back(t);
+            }
+        }
+        else {
+            if (numInside == 1) {
+                // Smaller tetrahedron
+                t.p[0] = *a;
+                EDGE(0, 0, t.p[1]);
+                EDGE(0, 1, t.p[2]);
+                EDGE(0, 2, t.p[3]);
+                out.push_back(t);
+            }
+            else if (numInside == 2) {
+                // Wedge with triangles (a, ac, ad) and (b, bc, bd), split into three tetrahedra
+                const SimplexVertex* b = &simplex.p[inside[1]];
+                SimplexVertex ac, ad, bc, bd;
+                EDGE(0, 0, ac);
+                EDGE(0, 1, ad);
+                EDGE(1, 0, bc);
+                EDGE(1, 1, bd);
+
+                t.p[0] = *a; t.p[1] = ac; t.p[2] = ad; t.p[3] = bd;
+                out.push_back(t);
+
+                t.p[0] = *a; t.p[1] = ac; t.p[2] = bd; t.p[3] = bc;
+                out.push_back(t);
+
+                t.p[0] = *a; t.p[1] = bc; t.p[2] = bd; t.p[3] = *b;
+                out.push_back(t);
+            }
+            else {
+                // Wedge with triangles (a, b, c) and (ad, bd, cd), split into three tetrahedra
+                const SimplexVertex* b = &simplex.p[inside[1]];
+                const SimplexVertex* c = &simplex.p[inside[2]];
+                SimplexVertex ad, bd, cd;
+                EDGE(0, 0, ad);
+                EDGE(1, 0, bd);
+                EDGE(2, 0, cd);
+
+                t.p[0] = *a; t.p[1] = *b; t.p[2] = *c; t.p[3] = cd;
+                out.push_back(t);
+
+                t.p[0] = *a; t.p[1] = *b; t.p[2] = cd; t.p[3] = bd;
+                out.push_back(t);
+
+                t.p[0] = *a; t.p[1] = bd; t.p[2] = cd; t.p[3] = ad;
+                out.push_back(t);
+            }
+        }
+
+        #undef EDGE
+    }
+}
+
+
+void BoxClipper::Cut(const Simplex& in, std::vector<Simplex>& out) {
+    int axis = clipType == VTKPipeline::CutX ? 0 :
+               clipType == VTKPipeline::CutY ? 1 : 2;
+
+    // Sort vertices by side of the cut plane
+    double d[4];
+    int above[4];
+    int below[4];
+    int numAbove = 0;
+    int numBelow = 0;
+    for (int i = 0; i < 4; i++) {
+        double b[3];
+        ToBox(in.p[i].x, b);
+        d[i] = b[axis];
+
+        if (d[i] > 0.0) above[numAbove++] = i;
+        else below[numBelow++] = i;
+    }
+
+    if (numAbove == 0 || numBelow == 0) return;
+
+    #define EDGE(i, j, v) Interpolate(in.p[i], in.p[j], d[i] / (d[i] - d[j]), v)
+
+    Simplex t;
+    t.numberOfPoints = 3;
+
+    if (numAbove == 2) {
+        // Quad with vertices on edges ac, ad, bd, bc
+        int a = above[0];
+        int b = above[1];
+        int c = below[0];
+        int e = below[1];
+
+        SimplexVertex ac, ae, be, bc;
+        EDGE(a, c, ac);
+        EDGE(a, e, ae);
+        EDGE(b, e, be);
+        EDGE(b, c, bc);
+
+        t.p[0] = ac; t.p[1] = ae; t.p[2] = be;
+        out.push_back(t);
+
+        t.p[0] = ac; t.p[1] = be; t.p[2] = bc;
+        out.push_back(t);
+    }
+    else {
+        // Triangle around the lone vertex
+        int* lone = numAbove == 1 ? above : below;
+        int* others = numAbove == 1 ? below : above;
+
+        for (int i = 0; i < 3; i++) {
+            EDGE(lone[0], others[i], t.p[i]);
+        }
+
+        out.push_back(t);
+    }
+
+    #undef EDGE
+}
+
+
+void BoxClipper::Interpolate(const SimplexVertex& a, const SimplexVertex& b, double t, SimplexVertex& out) {
+    for (int i = 0; i < 3; i++) {
+        out.x[i] = a.x[i] + t * (b.x[i] - a.x[i]);
+    }
+    for (int i = 0; i < NumberOfSimplexValues; i++) {
+        out.v[i] = a.v[i] + t * (b.v[i] - a.v[i]);
+    }
+}
@@ -0,0 +1,98 @@
+/*=========================================================================
+
+  Name:        BoxClipper.h
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+  Description: Clips triangles and tetrahedra against a clipping box
+               without going through the VTK pipeline.  Used for
+               evaluating many clipping boxes in one pass over the data.
+
+=========================================================================*/
+
+
+#ifndef BOXCLIPPER_H
+#define BOXCLIPPER_H
+
+
+#include <vector>
+
+
+// Point values carried along with each vertex and interpolated when clipping
+enum SimplexValue {
+    XYMagnitudeValue,
+    XYAngleValue,
+    ZComponentValue,
+    XDirectionValue,
+    YDirectionValue,
+    NumberOfSimplexValues
+};
+
+struct SimplexVertex {
+    double x[3];
+    double v[NumberOfSimplexValues];
+};
+
+// A triangle (3 points) or tetrahedron (4 points)
+struct Simplex {
+    int numberOfPoints;
+    SimplexVertex p[4];
+};
+
+
+class BoxClipper {
+public:
+    BoxClipper();
+
+    // Same parameters as VTKPipeline::SetClippingBox*() and SetClipType()
+    void SetBox(const double center[3], const double size[3], double rotation, int clipType);
+
+    // World-space bounds of the box
+    void GetBounds(double bounds[6]);
+
+    // Clip the simplex, appending the pieces inside the box to the output.
+    // Triangles are discarded by the cut types.
+    void Clip(const Simplex& in, std::vector<Simplex>& out);
+
+    // Area of a triangle or volume of a tetrahedron
+    static double ComputeMeasure(const Simplex& s);
+
+    // Average of the vertex positions
+    static void ComputeCenter(const Simplex& s, double center[3]);
+
+protected:
+    double center[3];
+    double size[3];
+    double cosTheta;
+    double sinTheta;
+    int clipType;
+
+    // Work buffers for successive plane clips
+    std::vector<Simplex> buffer1;
+    std::vector<Simplex> buffer2;
+
+    // Transform into the unit box coordinates used by VTKPipeline
+    void ToBox(const double x[3], double b[3]);
+
+    // Signed distance to plane i of the unit box, positive inside
+    double PlaneDistance(const double b[3], int plane);
+
+    // Clip by one plane of the unit box
+    void ClipPlane(const std::vector<Simplex>& in, std::vector<Simplex>& out, int plane);
+
+    // Cut a tetrahedron with the cut plane
+    void Cut(const Simplex& in, std::vector<Simplex>& out);
+
+    static void Interpolate(const SimplexVertex& a, const SimplexVertex& b, double t, SimplexVertex& out);
+};
+
+
+#endif
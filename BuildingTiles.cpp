@@ -0,0 +1,283 @@
+/*=========================================================================
+
+  Name:        BuildingTiles.cpp
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+  Description: Splits building geometry into a grid of tiles with one 
+               actor each, so the renderer's frustum culler can skip 
+               tiles out of view, and swaps in a simplified version of 
+               tiles that are small in the view.
+
+=========================================================================*/
+
+
+#include "BuildingTiles.h"
+
+#include <vtkActor.h>
+#include <vtkCamera.h>
+#include <vtkCellArray.h>
+#include <vtkMath.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkPolyDataMapper.h>
+#include <vtkProperty.h>
+#include <vtkQuadricClustering.h>
+#include <vtkRenderer.h>
+
+#include <math.h>
+
+
+// Target size of a tile
+static const vtkIdType cellsPerTile = 50000;
+
+// Limit on the grid, so tiny inputs with huge extents don't make empty tiles
+static const int maxTilesPerSide = 64;
+
+// Tiles with fewer cells are always drawn at full detail
+static const vtkIdType minCellsToSimplify = 2000;
+
+// Clustering grid for the simplified tiles
+static const int coarseDivisions = 32;
+
+// Fraction of the view height below which a tile is drawn simplified
+static const double coarseViewFraction = 0.1;
+
+
+BuildingTiles::BuildingTiles(vtkRenderer* ren) {
+    renderer = ren;
+    visibility = true;
+
+    property = vtkProperty::New();
+    property->SetColor(0.5, 0.5, 0.5);
+}
+
+BuildingTiles::~BuildingTiles() {
+    ClearTiles();
+
+    property->Delete();
+}
+
+
+void BuildingTiles::SetInput(vtkPolyData* buildings) {
+    ClearTiles();
+
+    if (buildings == NULL || buildings->GetNumberOfCells() == 0) return;
+
+    vtkIdType numCells = buildings->GetNumberOfCells();
+
+    double bounds[6];
+    buildings->GetBounds(bounds);
+    double width = bounds[1] - bounds[0];
+    double height = bounds[3] - bounds[2];
+
+    // Grid in x and y with roughly square tiles
+    double numTiles = ceil((double)numCells / cellsPerTile);
+    int nx = 1;
+    int ny = 1;
+    if (width > 0.0 && height > 0.0) {
+        nx = (int)ceil(sqrt(numTiles * width / height));
+        ny = (int)ceil(numTiles / nx);
+    }
+    else if (width > 0.0) {
+        nx = (int)numTiles;
+    }
+    else if (height > 0.0) {
+        ny = (int)numTiles;
+    }
+    nx = nx < 1 ? 1 : nx > maxTilesPerSide ? maxTilesPerSide : nx;
+    ny = ny < 1 ? 1 : ny > maxTilesPerSide ? maxTilesPerSide : ny;
+
+    // Assign cells to tiles by their centroid
+    std::vector< std::vector<vtkIdType> > tileCells(nx * ny);
+
+    vtkIdType numPts;
+    vtkIdType* pts;
+    double x[3];
+    for (vtkIdType i = 0; i < numCells; i++) {
+        buildings->GetCellPoints(i, numPts, pts);
+        if (numPts == 0) continue;
+
+        double cx = 0.0;
+        double cy = 0.0;
+        for (vtkIdType j = 0; j < numPts; j++) {
+            buildings->GetPoint(pts[j], x);
+            cx += x[0];
+            cy += x[1];
+        }
+        cx /= numPts;
+        cy /= numPts;
+
+        int ix = width > 0.0 ? (int)((cx - bounds[0]) / width * nx) : 0;
+        int iy = height > 0.0 ? (int)((cy - bounds[2]) / height * ny) : 0;
+        ix = ix < 0 ? 0 : ix >= nx ? nx - 1 : ix;
+        iy = iy < 0 ? 0 : iy >= ny ? ny - 1 : iy;
+
+        tileCells[iy * nx + ix].push_back(i);
+    }
+
+    std::vector<vtkIdType> pointMap(buildings->GetNumberOfPoints(), -1);
+
+    for (int i = 0; i < (int)tileCells.size(); i++) {
+        if (tileCells[i].empty()) continue;
+
+        AddTile(buildings, tileCells[i], pointMap);
+
+        // Free as we go, as the input can be large
+        std::vector<vtkIdType>().swap(tileCells[i]);
+    }
+}
+
+
+void BuildingTiles::SetVisibility(bool visible) {
+    visibility = visible;
+
+    for (int i = 0; i < (int)tiles.size(); i++) {
+        tiles[i].actor->SetVisibility(visibility);
+    }
+}
+
+bool BuildingTiles::GetVisibility() {
+    return visibility;
+}
+
+
+vtkProperty* BuildingTiles::GetProperty() {
+    return property;
+}
+
+
+void BuildingTiles::UpdateDetail(vtkCamera* camera) {
+    if (!visibility || camera == NULL) return;
+
+    double position[3];
+    camera->GetPosition(position);
+
+    // Height of the view at unit distance, or the fixed height for parallel projection
+    bool parallel = camera->GetParallelProjection() != 0;
+    double viewHeight = parallel ? 2.0 * camera->GetParallelScale() :
+                                   2.0 * tan(vtkMath::RadiansFromDegrees(camera->GetViewAngle() * 0.5));
+
+    for (int i = 0; i < (int)tiles.size(); i++) {
+        Tile& tile = tiles[i];
+        if (tile.coarseMapper == NULL) continue;
+
+        double fraction;
+        if (parallel) {
+            fraction = viewHeight > 0.0 ? tile.size / viewHeight : 1.0;
+        }
+        else {
+            double distance = sqrt(vtkMath::Distance2BetweenPoints(position, tile.center));
+
+            // Always use full detail when near or inside the tile
+            distance -= tile.size * 0.5;
+            fraction = distance > 0.0 ? tile.size / (distance * viewHeight) : 1.0;
+        }
+
+        vtkPolyDataMapper* mapper = fraction < coarseViewFraction ? tile.coarseMapper : tile.mapper;
+        if (tile.actor->GetMapper() != mapper) tile.actor->SetMapper(mapper);
+    }
+}
+
+
+void BuildingTiles::ClearTiles() {
+    for (int i = 0; i < (int)tiles.size(); i++) {
+        if (renderer) renderer->RemoveViewProp(tiles[i].actor);
+
+        tiles[i].actor->Delete();
+        tiles[i].mapper->Delete();
+        if (tiles[i].coarseMapper) tiles[i].coarseMapper->Delete();
+    }
+
+    tiles.clear();
+}
+
+
+void BuildingTiles::AddTile(vtkPolyData* buildings, const std::vector<vtkIdType>& cells, std::vector<vtkIdType>& pointMap) {
+    vtkPoints* points = vtkPoints::New();
+    vtkCellArray* polys = vtkCellArray::New();
+    polys->Allocate(cells.size() * 4);
+
+    std::vector<vtkIdType> usedPoints;
+    std::vector<vtkIdType> ids;
+
+    vtkIdType numPts;
+    vtkIdType* pts;
+    for (int i = 0; i < (int)cells.size(); i++) {
+        buildings->GetCellPoints(cells[i], numPts, pts);
+
+        ids.resize(numPts);
+        for (vtkIdType j = 0; j < numPts; j++) {
+            vtkIdType& id = pointMap[pts[j]];
+            if (id < 0) {
+                id = points->InsertNextPoint(buildings->GetPoint(pts[j]));
+                usedPoints.push_back(pts[j]);
+            }
+            ids[j] = id;
+        }
+
+        polys->InsertNextCell(numPts, &ids[0]);
+    }
+
+    // Reset the map for the next tile
+    for (int i = 0; i < (int)usedPoints.size(); i++) {
+        pointMap[usedPoints[i]] = -1;
+    }
+
+    vtkPolyData* polyData = vtkPolyData::New();
+    polyData->SetPoints(points);
+    polyData->SetPolys(polys);
+    points->Delete();
+    polys->Delete();
+
+    Tile tile;
+
+    tile.mapper = vtkPolyDataMapper::New();
+    tile.mapper->SetInput(polyData);
+
+    // Build the simplified version now, so switching doesn't stall a frame
+    tile.coarseMapper = NULL;
+    if ((vtkIdType)cells.size() >= minCellsToSimplify) {
+        vtkQuadricClustering* cluster = vtkQuadricClustering::New();
+        cluster->SetInput(polyData);
+        cluster->SetNumberOfDivisions(coarseDivisions, coarseDivisions, coarseDivisions);
+        cluster->Update();
+
+        vtkPolyData* coarse = vtkPolyData::New();
+        coarse->ShallowCopy(cluster->GetOutput());
+        cluster->Delete();
+
+        tile.coarseMapper = vtkPolyDataMapper::New();
+        tile.coarseMapper->SetInput(coarse);
+        coarse->Delete();
+    }
+
+    double bounds[6];
+    polyData->GetBounds(bounds);
+    polyData->Delete();
+
+    tile.center[0] = (bounds[0] + bounds[1]) * 0.5;
+    tile.center[1] = (bounds[2] + bounds[3]) * 0.5;
+    tile.center[2] = (bounds[4] + bounds[5]) * 0.5;
+    tile.size = sqrt((bounds[1] - bounds[0]) * (bounds[1] - bounds[0]) +
+                     (bounds[3] - bounds[2]) * (bounds[3] - bounds[2]) +
+                     (bounds[5] - bounds[4]) * (bounds[5] - bounds[4]));
+
+    // One actor per tile, culled by the renderer against the view frustum using its bounds
+    tile.actor = vtkActor::New();
+    tile.actor->SetMapper(tile.mapper);
+    tile.actor->SetProperty(property);
+    tile.actor->SetVisibility(visibility);
+
+    if (renderer) renderer->AddViewProp(tile.actor);
+
+    tiles.push_back(tile);
+}
@@ -0,0 +1,78 @@
+/*=========================================================================
+
+  Name:        BuildingTiles.h
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+  Description: Splits building geometry into a grid of tiles with one 
+               actor each, so the renderer's frustum culler can skip 
+               tiles out of view, and swaps in a simplified version of 
+               tiles that are small in the view.
+
+=========================================================================*/
+
+
+#ifndef BUILDINGTILES_H
+#define BUILDINGTILES_H
+
+
+#include <vtkType.h>
+
+#include <vector>
+
+class vtkActor;
+class vtkCamera;
+class vtkPolyData;
+class vtkPolyDataMapper;
+class vtkProperty;
+class vtkRenderer;
+
+
+class BuildingTiles {
+public:
+    BuildingTiles(vtkRenderer* ren);
+    ~BuildingTiles();
+
+    // Split the buildings into tiles, replacing any previous tiles
+    void SetInput(vtkPolyData* buildings);
+
+    void SetVisibility(bool visible);
+    bool GetVisibility();
+
+    // Property shared by all tiles
+    vtkProperty* GetProperty();
+
+    // Choose the detail of each tile for the camera.  Call before rendering.
+    void UpdateDetail(vtkCamera* camera);
+
+protected:
+    vtkRenderer* renderer;
+    vtkProperty* property;
+    bool visibility;
+
+    struct Tile {
+        vtkActor* actor;
+        vtkPolyDataMapper* mapper;
+
+        // NULL if the tile is too small to simplify
+        vtkPolyDataMapper* coarseMapper;
+
+        double center[3];
+        double size;
+    };
+    std::vector<Tile> tiles;
+
+    void ClearTiles();
+    void AddTile(vtkPolyData* buildings, const std::vector<vtkIdType>& cells, std::vector<vtkIdType>& pointMap);
+};
+
+
+#endif
@@ -0,0 +1,303 @@
+/*=========================================================================
+
+  Name:        CSVWriter.cpp
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+  Description: Writes a CellTable as comma-separated text.  Chunks of
+               rows are formatted, and optionally gzip compressed, on
+               all threads and written to the file in order.
+
+=========================================================================*/
+
+
+#include "CSVWriter.h"
+
+#include "CellTable.h"
+
+#include <vtkConditionVariable.h>
+#include <vtkMutexLock.h>
+
+#include <vtk_zlib.h>
+
+#include <iostream>
+
+#include <locale.h>
+#include <stdio.h>
+#include <string.h>
+
+
+// Rows per chunk, which gives a few megabytes of text
+static const int rowsPerChunk = 65536;
+
+// Longest output of %g for a double, plus the separator
+static const int maxValueLength = 32;
+
+
+CSVWriter::CSVWriter() {
+    compress = false;
+
+    input = NULL;
+    decimalPoint = '.';
+
+    numChunks = 0;
+    nextChunk = 0;
+    error = false;
+
+    lock = vtkMutexLock::New();
+    condition = vtkConditionVariable::New();
+}
+
+CSVWriter::~CSVWriter() {
+    lock->Delete();
+    condition->Delete();
+}
+
+
+void CSVWriter::SetCompress(bool gzip) {
+    compress = gzip;
+}
+
+bool CSVWriter::GetCompress() {
+    return compress;
+}
+
+
+bool CSVWriter::Write(CellTable* table, const char* fileName) {
+    if (!Open(fileName, table)) return false;
+
+    Append(table);
+
+    return Close();
+}
+
+
+bool CSVWriter::Open(const char* fileName, CellTable* header) {
+    file.open(fileName, std::ios::out | std::ios::binary);
+
+    if (!file.good()) {
+        std::cout << "Could not open " << fileName << " for writing" << std::endl;
+        return false;
+    }
+
+    name = fileName;
+    error = false;
+
+    // sprintf() uses the decimal point of the current C locale, which the
+    // GUI may have set from the environment
+    decimalPoint = localeconv()->decimal_point[0];
+
+    // Write header
+    std::string names;
+    for (int i = 0; i < header->GetNumberOfColumns(); i++) {
+        names += (i > 0 ? ", " : "") + header->GetColumnName(i);
+    }
+    names += "\n";
+
+    Buffer buffer;
+    buffer.data.assign(names.begin(), names.end());
+    buffer.size = names.size();
+
+    if (compress && !CompressBuffer(buffer)) error = true;
+    if (!error && !WriteBuffer(buffer)) error = true;
+
+    return !error;
+}
+
+
+bool CSVWriter::Append(CellTable* table) {
+    if (error) return false;
+
+    input = table;
+
+    vtkMultiThreader* threader = vtkMultiThreader::New();
+    int numThreads = threader->GetNumberOfThreads();
+
+    numChunks = (int)((input->GetNumberOfRows() + rowsPerChunk - 1) / rowsPerChunk);
+    nextChunk = 0;
+
+    // Two buffers per thread, so formatting can continue while writing
+    buffers.resize(numThreads * 2);
+    for (int i = 0; i < (int)buffers.size(); i++) {
+        buffers[i].size = 0;
+        buffers[i].chunk = i;
+        buffers[i].ready = false;
+        buffers[i].failed = false;
+    }
+
+    if (numThreads > 1 && numChunks > 1) {
+        threader->SetSingleMethod(ThreadFunction, this);
+        threader->SingleMethodExecute();
+    }
+    else {
+        for (int i = 0; i < numChunks && !error; i++) {
+            if (!FormatChunk(i, buffers[0]) || !WriteBuffer(buffers[0])) error = true;
+        }
+    }
+
+    threader->Delete();
+
+    input = NULL;
+
+    return !error;
+}
+
+
+bool CSVWriter::Close() {
+    buffers.clear();
+
+    file.close();
+
+    if (error) {
+        std::cout << "Error writing " << name << std::endl;
+    }
+
+    return !error;
+}
+
+
+bool CSVWriter::FormatChunk(int chunk, Buffer& buffer) {
+    vtkIdType start = (vtkIdType)chunk * rowsPerChunk;
+    vtkIdType end = start + rowsPerChunk;
+    end = end < input->GetNumberOfRows() ? end : input->GetNumberOfRows();
+
+    int numColumns = input->GetNumberOfColumns();
+
+    std::vector<const double*> columns(numColumns);
+    for (int i = 0; i < numColumns; i++) {
+        columns[i] = &input->GetColumn(i)[0];
+    }
+
+    buffer.data.resize((size_t)(end - start) * numColumns * maxValueLength + 1);
+
+    char* p = &buffer.data[0];
+    for (vtkIdType i = start; i < end; i++) {
+        for (int j = 0; j < numColumns; j++) {
+            if (j > 0) {
+                *p++ = ',';
+                *p++ = ' ';
+            }
+
+            char* value = p;
+            p += sprintf(p, "%g", columns[j][i]);
+
+            if (decimalPoint != '.') {
+                for (char* c = value; c < p; c++) {
+                    if (*c == decimalPoint) *c = '.';
+                }
+            }
+        }
+        *p++ = '\n';
+    }
+
+    buffer.size = p - &buffer.data[0];
+
+    return !compress || CompressBuffer(buffer);
+}
+
+
+bool CSVWriter::CompressBuffer(Buffer& buffer) {
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+
+    // Window bits + 16 for a gzip header and trailer
+    if (deflateInit2(&stream, Z_BEST_SPEED, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return false;
+    }
+
+    // Older versions of deflateBound() don't count the gzip header
+    std::vector<char> compressed(deflateBound(&stream, buffer.size) + 32);
+
+    stream.next_in = (Bytef*)&buffer.data[0];
+    stream.avail_in = buffer.size;
+    stream.next_out = (Bytef*)&compressed[0];
+    stream.avail_out = compressed.size();
+
+    int result = deflate(&stream, Z_FINISH);
+
+    buffer.size = stream.total_out;
+    buffer.data.swap(compressed);
+
+    deflateEnd(&stream);
+
+    return result == Z_STREAM_END;
+}
+
+
+bool CSVWriter::WriteBuffer(Buffer& buffer) {
+    file.write(&buffer.data[0], buffer.size);
+
+    return file.good();
+}
+
+
+VTK_THREAD_RETURN_TYPE CSVWriter::ThreadFunction(void* arg) {
+    vtkMultiThreader::ThreadInfo* info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+    CSVWriter* self = static_cast<CSVWriter*>(info->UserData);
+
+    self->ThreadExecute(info->ThreadID, info->NumberOfThreads);
+
+    return VTK_THREAD_RETURN_VALUE;
+}
+
+void CSVWriter::ThreadExecute(int thread, int numThreads) {
+    int numBuffers = (int)buffers.size();
+
+    if (thread == 0) {
+        // Write the chunks in order
+        for (int chunk = 0; chunk < numChunks; chunk++) {
+            Buffer& buffer = buffers[chunk % numBuffers];
+
+            lock->Lock();
+            while (buffer.chunk != chunk || !buffer.ready) {
+                condition->Wait(lock);
+            }
+            bool failed = error || buffer.failed;
+            lock->Unlock();
+
+            // Once anything fails, the remaining chunks are skipped but
+            // still handed on, so the formatting threads finish
+            if (!failed && !WriteBuffer(buffer)) failed = true;
+
+            // Hand the buffer on to the next chunk that uses it
+            lock->Lock();
+            if (failed) error = true;
+            buffer.chunk = chunk + numBuffers;
+            buffer.ready = false;
+            condition->Broadcast();
+            lock->Unlock();
+        }
+
+        return;
+    }
+
+    // Format chunks
+    lock->Lock();
+    while (nextChunk < numChunks) {
+        int chunk = nextChunk++;
+        Buffer& buffer = buffers[chunk % numBuffers];
+
+        // Wait for the previous chunk in this buffer to be written
+        while (buffer.chunk != chunk) {
+            condition->Wait(lock);
+        }
+        bool skip = error;
+        lock->Unlock();
+
+        bool failed = skip || !FormatChunk(chunk, buffer);
+
+        lock->Lock();
+        buffer.failed = failed;
+        buffer.ready = true;
+        condition->Broadcast();
+    }
+    lock->Unlock();
+}
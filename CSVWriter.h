@@ -0,0 +1,98 @@
+/*=========================================================================
+
+  Name:        CSVWriter.h
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+  Description: Writes a CellTable as comma-separated text.  Chunks of
+               rows are formatted, and optionally gzip compressed, on
+               all threads and written to the file in order.
+
+=========================================================================*/
+
+
+#ifndef CSVWRITER_H
+#define CSVWRITER_H
+
+
+#include <vtkMultiThreader.h>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+class CellTable;
+class vtkConditionVariable;
+class vtkMutexLock;
+
+
+class CSVWriter {
+public:
+    CSVWriter();
+    ~CSVWriter();
+
+    // Write gzip compressed output.  Each chunk is a separate gzip
+    // member, which gzip, zlib and pandas read as one stream.
+    void SetCompress(bool gzip);
+    bool GetCompress();
+
+    // Write a whole table
+    bool Write(CellTable* table, const char* fileName);
+
+    // Write several tables with the same columns to one file: open with
+    // the header from the first, then append the rows of each
+    bool Open(const char* fileName, CellTable* header);
+    bool Append(CellTable* table);
+    bool Close();
+
+protected:
+    bool compress;
+
+    CellTable* input;
+    std::ofstream file;
+    std::string name;
+    char decimalPoint;
+
+    // Chunks are formatted into a ring of buffers, and chunk i uses
+    // buffer i % number of buffers
+    struct Buffer {
+        std::vector<char> data;
+        size_t size;
+        int chunk;
+        bool ready;
+
+        // Formatting failed or was skipped, so the writer should stop
+        bool failed;
+    };
+    std::vector<Buffer> buffers;
+
+    int numChunks;
+    int nextChunk;
+
+    // Only changed by the writer thread while writing in parallel, and
+    // read by the formatting threads under the lock
+    bool error;
+
+    vtkMutexLock* lock;
+    vtkConditionVariable* condition;
+
+    // Format (and compress) a chunk of rows
+    bool FormatChunk(int chunk, Buffer& buffer);
+    bool CompressBuffer(Buffer& buffer);
+
+    bool WriteBuffer(Buffer& buffer);
+
+    static VTK_THREAD_RETURN_TYPE ThreadFunction(void* arg);
+    void ThreadExecute(int thread, int numThreads);
+};
+
+
+#endif
@@ -0,0 +1,194 @@
+/*=========================================================================
+
+  Name:        CameraPath.cpp
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+  Description: Keyframed camera views, and optionally clip settings, for
+               rendering movies.  Cameras are interpolated with splines,
+               clip settings linearly.
+
+=========================================================================*/
+
+
+#include "CameraPath.h"
+
+#include <vtkCamera.h>
+#include <vtkCameraInterpolator.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include <stdio.h>
+
+
+CameraPath::CameraPath() {
+    interpolator = vtkCameraInterpolator::New();
+    interpolator->SetInterpolationTypeToSpline();
+
+    keyframe = vtkCamera::New();
+
+    startTime = 0.0;
+    endTime = 0.0;
+    numKeyframes = 0;
+}
+
+CameraPath::~CameraPath() {
+    interpolator->Delete();
+    keyframe->Delete();
+}
+
+
+bool CameraPath::Read(const char* fileName) {
+    std::ifstream file;
+    file.open(fileName);
+
+    if (!file.good()) {
+        std::cout << "Could not open " << fileName << " for reading" << std::endl;
+        return false;
+    }
+
+    interpolator->Initialize();
+    clips.clear();
+    numKeyframes = 0;
+
+    std::string line;
+    while (std::getline(file, line)) {
+        double t;
+        double p[3];
+        double f[3];
+        double u[3];
+        Clip clip;
+
+        int n = sscanf(line.c_str(), "%lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %lf %d",
+                       &t, &p[0], &p[1], &p[2], &f[0], &f[1], &f[2], &u[0], &u[1], &u[2],
+                       &clip.center[0], &clip.center[1], &clip.center[2],
+                       &clip.size[0], &clip.size[1], &clip.size[2],
+                       &clip.rotation, &clip.type);
+
+        if (n < 10) continue;
+
+        // The interpolator copies the camera
+        keyframe->SetPosition(p);
+        keyframe->SetFocalPoint(f);
+        keyframe->SetViewUp(u);
+        interpolator->AddCamera(t, keyframe);
+
+        if (n == 18) {
+            clip.time = t;
+            clips.push_back(clip);
+        }
+
+        startTime = numKeyframes == 0 || t < startTime ? t : startTime;
+        endTime = numKeyframes == 0 || t > endTime ? t : endTime;
+        numKeyframes++;
+    }
+
+    file.close();
+
+    if (numKeyframes == 0) {
+        std::cout << "No keyframes in " << fileName << std::endl;
+        return false;
+    }
+
+    std::sort(clips.begin(), clips.end());
+
+    return true;
+}
+
+
+bool CameraPath::Append(const char* fileName, double time, vtkCamera* camera,
+                        const double center[3], const double size[3], double rotation, int type) {
+    bool exists = std::ifstream(fileName).good();
+
+    std::ofstream file;
+    file.open(fileName, std::ios::out | std::ios::app);
+
+    if (!file.good()) {
+        std::cout << "Could not open " << fileName << " for writing" << std::endl;
+        return false;
+    }
+
+    if (!exists) {
+        file << "Time, Position, Focal Point, View Up, Center, Size, Rotation, Type" << std::endl;
+    }
+
+    double* p = camera->GetPosition();
+    double* f = camera->GetFocalPoint();
+    double* u = camera->GetViewUp();
+
+    file << time << " " <<
+            p[0] << " " << p[1] << " " << p[2] << " " <<
+            f[0] << " " << f[1] << " " << f[2] << " " <<
+            u[0] << " " << u[1] << " " << u[2] << " " <<
+            center[0] << " " << center[1] << " " << center[2] << " " <<
+            size[0] << " " << size[1] << " " << size[2] << " " <<
+            rotation << " " << type << std::endl;
+
+    file.close();
+
+    return true;
+}
+
+
+int CameraPath::GetNumberOfKeyframes() {
+    return numKeyframes;
+}
+
+double CameraPath::GetStartTime() {
+    return startTime;
+}
+
+double CameraPath::GetEndTime() {
+    return endTime;
+}
+
+
+void CameraPath::InterpolateCamera(double t, vtkCamera* camera) {
+    if (numKeyframes == 0) return;
+
+    // Only the view is interpolated, so keep the current view angle
+    double viewAngle = camera->GetViewAngle();
+    double parallelScale = camera->GetParallelScale();
+
+    interpolator->InterpolateCamera(t, camera);
+
+    camera->SetViewAngle(viewAngle);
+    camera->SetParallelScale(parallelScale);
+}
+
+
+bool CameraPath::HasClip() {
+    return !clips.empty();
+}
+
+void CameraPath::InterpolateClip(double t, double center[3], double size[3], double& rotation, int& type) {
+    if (clips.empty()) return;
+
+    // Find the keyframes either side
+    int i = 0;
+    while (i < (int)clips.size() - 1 && clips[i + 1].time <= t) i++;
+
+    const Clip& c0 = clips[i];
+    const Clip& c1 = i < (int)clips.size() - 1 ? clips[i + 1] : clips[i];
+
+    double s = c1.time > c0.time ? (t - c0.time) / (c1.time - c0.time) : 0.0;
+    s = s < 0.0 ? 0.0 : s > 1.0 ? 1.0 : s;
+
+    for (int j = 0; j < 3; j++) {
+        center[j] = c0.center[j] + (c1.center[j] - c0.center[j]) * s;
+        size[j] = c0.size[j] + (c1.size[j] - c0.size[j]) * s;
+    }
+    rotation = c0.rotation + (c1.rotation - c0.rotation) * s;
+    type = c0.type;
+}
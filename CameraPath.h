@@ -0,0 +1,81 @@
+/*=========================================================================
+
+  Name:        CameraPath.h
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+  Description: Keyframed camera views, and optionally clip settings, for
+               rendering movies.  Cameras are interpolated with splines,
+               clip settings linearly.
+
+=========================================================================*/
+
+
+#ifndef CAMERAPATH_H
+#define CAMERAPATH_H
+
+
+#include <vector>
+
+class vtkCamera;
+class vtkCameraInterpolator;
+
+
+class CameraPath {
+public:
+    CameraPath();
+    ~CameraPath();
+
+    // Read keyframes, one per line: time, then camera position, focal point
+    // and view up as in VTKPipeline::SaveCameraView(), optionally followed
+    // by clip center, size, rotation and type as in SaveClipSettings().
+    // Any line that doesn't parse is treated as a header.
+    bool Read(const char* fileName);
+
+    // Append a keyframe, writing a header if the file is new
+    static bool Append(const char* fileName, double time, vtkCamera* camera,
+                       const double center[3], const double size[3], double rotation, int type);
+
+    int GetNumberOfKeyframes();
+    double GetStartTime();
+    double GetEndTime();
+
+    void InterpolateCamera(double t, vtkCamera* camera);
+
+    // Clip settings are only interpolated if some keyframes have them.  The
+    // type is taken from the previous keyframe.
+    bool HasClip();
+    void InterpolateClip(double t, double center[3], double size[3], double& rotation, int& type);
+
+protected:
+    vtkCameraInterpolator* interpolator;
+    vtkCamera* keyframe;
+
+    struct Clip {
+        double time;
+        double center[3];
+        double size[3];
+        double rotation;
+        int type;
+
+        bool operator<(const Clip& other) const {
+            return time < other.time;
+        }
+    };
+    std::vector<Clip> clips;
+
+    double startTime;
+    double endTime;
+    int numKeyframes;
+};
+
+
+#endif
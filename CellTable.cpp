@@ -0,0 +1,409 @@
+/*=========================================================================
+
+  Name:        CellTable.cpp
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+  Description: Table with one row per triangle or tetrahedron of a data
+               set, holding the cell value, area/volume and center as
+               columns.  Can be written as text or NumPy binary files.
+
+=========================================================================*/
+
+
+#include "CellTable.h"
+
+#include "CSVWriter.h"
+#include "SimplexReader.h"
+
+#include <vtkConfigure.h>
+#include <vtkDataSet.h>
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include <string.h>
+
+
+// Rows are interleaved into blocks of this many for structured arrays
+static const int rowsPerBlock = 65536;
+
+#ifdef VTK_WORDS_BIGENDIAN
+static const char* doubleType = "'>f8'";
+#else
+static const char* doubleType = "'<f8'";
+#endif
+
+
+// Little-endian output for the zip structures
+static void WriteUInt16(std::ostream& out, unsigned int v) {
+    char b[2] = { (char)(v & 0xFF), (char)((v >> 8) & 0xFF) };
+    out.write(b, 2);
+}
+
+static void WriteUInt32(std::ostream& out, unsigned long v) {
+    char b[4];
+    for (int i = 0; i < 4; i++) b[i] = (char)((v >> (8 * i)) & 0xFF);
+    out.write(b, 4);
+}
+
+static void WriteUInt64(std::ostream& out, vtkTypeUInt64 v) {
+    char b[8];
+    for (int i = 0; i < 8; i++) b[i] = (char)((v >> (8 * i)) & 0xFF);
+    out.write(b, 8);
+}
+
+
+// CRC-32 as used by zip
+static unsigned long crcTable[256];
+static bool crcTableInitialized = false;
+
+static unsigned long UpdateCRC(unsigned long crc, const char* data, size_t length) {
+    if (!crcTableInitialized) {
+        for (unsigned long i = 0; i < 256; i++) {
+            unsigned long c = i;
+            for (int k = 0; k < 8; k++) {
+                c = c & 1 ? 0xEDB88320UL ^ (c >> 1) : c >> 1;
+            }
+            crcTable[i] = c;
+        }
+        crcTableInitialized = true;
+    }
+
+    crc = crc ^ 0xFFFFFFFFUL;
+    for (size_t i = 0; i < length; i++) {
+        crc = crcTable[(crc ^ (unsigned char)data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFUL;
+}
+
+
+CellTable::CellTable() {
+    Initialize(XYMagnitudeValue, "Size");
+}
+
+
+void CellTable::Initialize(int value, const char* sizeName) {
+    simplexValue = value;
+
+    names.clear();
+    names.push_back("Value");
+    names.push_back(sizeName);
+    names.push_back("X");
+    names.push_back("Y");
+    names.push_back("Z");
+
+    columns.clear();
+    columns.resize(names.size());
+}
+
+
+void CellTable::AddSimplex(const Simplex& s) {
+    // Cell value is the average of the point values
+    double cellValue = 0.0;
+    for (int k = 0; k < s.numberOfPoints; k++) {
+        cellValue += s.p[k].v[simplexValue];
+    }
+    cellValue /= s.numberOfPoints;
+
+    double center[3];
+    BoxClipper::ComputeCenter(s, center);
+
+    columns[0].push_back(cellValue);
+    columns[1].push_back(BoxClipper::ComputeMeasure(s));
+    columns[2].push_back(center[0]);
+    columns[3].push_back(center[1]);
+    columns[4].push_back(center[2]);
+}
+
+
+void CellTable::Add(const CellTable& other) {
+    for (int i = 0; i < (int)columns.size(); i++) {
+        columns[i].insert(columns[i].end(), other.columns[i].begin(), other.columns[i].end());
+    }
+}
+
+
+void CellTable::Compute(vtkDataSet* data, int value, const char* sizeName) {
+    Initialize(value, sizeName);
+
+    if (data == NULL) return;
+
+    for (int i = 0; i < (int)columns.size(); i++) {
+        columns[i].reserve(data->GetNumberOfCells());
+    }
+
+    SimplexReader reader(data);
+    std::vector<Simplex> simplices;
+
+    for (vtkIdType i = 0; i < data->GetNumberOfCells(); i++) {
+        simplices.clear();
+        reader.GetSimplices(i, simplices);
+
+        for (int j = 0; j < (int)simplices.size(); j++) {
+            AddSimplex(simplices[j]);
+        }
+    }
+}
+
+
+vtkIdType CellTable::GetNumberOfRows() {
+    return columns.empty() ? 0 : (vtkIdType)columns[0].size();
+}
+
+int CellTable::GetNumberOfColumns() {
+    return (int)columns.size();
+}
+
+
+const std::string& CellTable::GetColumnName(int column) {
+    return names[column];
+}
+
+const std::vector<double>& CellTable::GetColumn(int column) {
+    return columns[column];
+}
+
+
+bool CellTable::Write(const char* fileName) {
+    std::string name(fileName);
+    std::string extension = name.size() >= 4 ? name.substr(name.size() - 4) : "";
+
+    if (extension == ".npy") return WriteNpy(fileName);
+    if (extension == ".npz") return WriteNpz(fileName);
+
+    return WriteText(fileName, name.size() >= 3 && name.substr(name.size() - 3) == ".gz");
+}
+
+
+bool CellTable::WriteText(const char* fileName, bool compress) {
+    CSVWriter writer;
+    writer.SetCompress(compress);
+
+    return writer.Write(this, fileName);
+}
+
+
+bool CellTable::WriteNpy(const char* fileName) {
+    std::ofstream file;
+    file.open(fileName, std::ios::out | std::ios::binary);
+
+    if (!file.good()) {
+        std::cout << "Could not open " << fileName << " for writing" << std::endl;
+        return false;
+    }
+
+    std::string header = NpyHeader(NpyDescription(), GetNumberOfRows());
+    file.write(header.data(), header.size());
+
+    WriteNpyRows(file);
+
+    file.close();
+
+    return file.good();
+}
+
+
+bool CellTable::WriteNpz(const char* fileName) {
+    std::ofstream file;
+    file.open(fileName, std::ios::out | std::ios::binary);
+
+    if (!file.good()) {
+        std::cout << "Could not open " << fileName << " for writing" << std::endl;
+        return false;
+    }
+
+    // Uncompressed zip archive with a .npy file for each column, using
+    // zip64 extensions when the offsets or sizes need them
+    const vtkTypeUInt64 zip64Limit = 0xFFFFFFFFUL;
+
+    std::string header = NpyHeader(doubleType, GetNumberOfRows());
+
+    std::vector<unsigned long> crcs;
+    std::vector<vtkTypeUInt64> sizes;
+    std::vector<vtkTypeUInt64> offsets;
+
+    vtkTypeUInt64 offset = 0;
+
+    for (int i = 0; i < GetNumberOfColumns(); i++) {
+        std::string name = names[i] + ".npy";
+
+        const char* data = columns[i].empty() ? NULL : (const char*)&columns[i][0];
+        vtkTypeUInt64 dataSize = (vtkTypeUInt64)columns[i].size() * sizeof(double);
+        vtkTypeUInt64 size = header.size() + dataSize;
+
+        unsigned long crc = UpdateCRC(0, header.data(), header.size());
+        crc = UpdateCRC(crc, data, dataSize);
+
+        bool zip64 = size >= zip64Limit;
+
+        // Local file header
+        WriteUInt32(file, 0x04034b50UL);
+        WriteUInt16(file, zip64 ? 45 : 20);
+        WriteUInt16(file, 0);
+        WriteUInt16(file, 0);
+        WriteUInt16(file, 0);
+        WriteUInt16(file, 0x21);
+        WriteUInt32(file, crc);
+        WriteUInt32(file, zip64 ? zip64Limit : (unsigned long)size);
+        WriteUInt32(file, zip64 ? zip64Limit : (unsigned long)size);
+        WriteUInt16(file, name.size());
+        WriteUInt16(file, zip64 ? 20 : 0);
+        file.write(name.data(), name.size());
+
+        if (zip64) {
+            WriteUInt16(file, 0x0001);
+            WriteUInt16(file, 16);
+            WriteUInt64(file, size);
+            WriteUInt64(file, size);
+        }
+
+        file.write(header.data(), header.size());
+        if (dataSize > 0) file.write(data, dataSize);
+
+        crcs.push_back(crc);
+        sizes.push_back(size);
+        offsets.push_back(offset);
+
+        offset += 30 + name.size() + (zip64 ? 20 : 0) + size;
+    }
+
+    // Central directory
+    vtkTypeUInt64 directoryOffset = offset;
+    bool zip64Archive = directoryOffset >= zip64Limit;
+
+    for (int i = 0; i < GetNumberOfColumns(); i++) {
+        std::string name = names[i] + ".npy";
+
+        bool zip64 = sizes[i] >= zip64Limit || offsets[i] >= zip64Limit;
+        zip64Archive = zip64Archive || zip64;
+
+        WriteUInt32(file, 0x02014b50UL);
+        WriteUInt16(file, 45);
+        WriteUInt16(file, zip64 ? 45 : 20);
+        WriteUInt16(file, 0);
+        WriteUInt16(file, 0);
+        WriteUInt16(file, 0);
+        WriteUInt16(file, 0x21);
+        WriteUInt32(file, crcs[i]);
+        WriteUInt32(file, zip64 ? zip64Limit : (unsigned long)sizes[i]);
+        WriteUInt32(file, zip64 ? zip64Limit : (unsigned long)sizes[i]);
+        WriteUInt16(file, name.size());
+        WriteUInt16(file, zip64 ? 28 : 0);
+        WriteUInt16(file, 0);
+        WriteUInt16(file, 0);
+        WriteUInt16(file, 0);
+        WriteUInt32(file, 0);
+        WriteUInt32(file, zip64 ? zip64Limit : (unsigned long)offsets[i]);
+        file.write(name.data(), name.size());
+
+        if (zip64) {
+            WriteUInt16(file, 0x0001);
+            WriteUInt16(file, 24);
+            WriteUInt64(file, sizes[i]);
+            WriteUInt64(file, sizes[i]);
+            WriteUInt64(file, offsets[i]);
+        }
+
+        offset += 46 + name.size() + (zip64 ? 28 : 0);
+    }
+
+    vtkTypeUInt64 directorySize = offset - directoryOffset;
+    int numEntries = GetNumberOfColumns();
+
+    if (zip64Archive) {
+        // Zip64 end of central directory record and locator
+        WriteUInt32(file, 0x06064b50UL);
+        WriteUInt64(file, 44);
+        WriteUInt16(file, 45);
+        WriteUInt16(file, 45);
+        WriteUInt32(file, 0);
+        WriteUInt32(file, 0);
+        WriteUInt64(file, numEntries);
+        WriteUInt64(file, numEntries);
+        WriteUInt64(file, directorySize);
+        WriteUInt64(file, directoryOffset);
+
+        WriteUInt32(file, 0x07064b50UL);
+        WriteUInt32(file, 0);
+        WriteUInt64(file, offset);
+        WriteUInt32(file, 1);
+    }
+
+    // End of central directory record
+    WriteUInt32(file, 0x06054b50UL);
+    WriteUInt16(file, 0);
+    WriteUInt16(file, 0);
+    WriteUInt16(file, numEntries);
+    WriteUInt16(file, numEntries);
+    WriteUInt32(file, zip64Archive ? zip64Limit : (unsigned long)directorySize);
+    WriteUInt32(file, zip64Archive ? zip64Limit : (unsigned long)directoryOffset);
+    WriteUInt16(file, 0);
+
+    file.close();
+
+    return file.good();
+}
+
+
+std::string CellTable::NpyDescription() {
+    std::string descr = "[";
+    for (int i = 0; i < GetNumberOfColumns(); i++) {
+        descr += (i > 0 ? ", ('" : "('") + names[i] + "', " + doubleType + ")";
+    }
+    descr += "]";
+
+    return descr;
+}
+
+
+std::string CellTable::NpyHeader(const std::string& descr, vtkIdType numRows, size_t minLength) {
+    std::ostringstream dict;
+    dict << "{'descr': " << descr << ", 'fortran_order': False, 'shape': (" << numRows << ",), }";
+
+    // Pad with spaces so the data starts on a 64-byte boundary
+    std::string header = dict.str();
+    size_t length = 10 + header.size() + 1;
+    length = length > minLength ? length : minLength;
+    length += (64 - length % 64) % 64;
+    header.append(length - 10 - header.size() - 1, ' ');
+    header += '\n';
+
+    size_t headerLength = header.size();
+
+    std::string out("\x93NUMPY\x01\x00", 8);
+    out += (char)(headerLength & 0xFF);
+    out += (char)((headerLength >> 8) & 0xFF);
+
+    return out + header;
+}
+
+
+void CellTable::WriteNpyRows(std::ostream& out) {
+    // Interleave the columns into blocks of rows
+    int numColumns = GetNumberOfColumns();
+    std::vector<double> block((size_t)rowsPerBlock * numColumns);
+
+    vtkIdType numRows = GetNumberOfRows();
+    for (vtkIdType start = 0; start < numRows; start += rowsPerBlock) {
+        vtkIdType end = start + rowsPerBlock < numRows ? start + rowsPerBlock : numRows;
+
+        double* b = &block[0];
+        for (vtkIdType i = start; i < end; i++) {
+            for (int j = 0; j < numColumns; j++) {
+                *b++ = columns[j][i];
+            }
+        }
+
+        out.write((const char*)&block[0], (end - start) * numColumns * sizeof(double));
+    }
+}
@@ -0,0 +1,91 @@
+/*=========================================================================
+
+  Name:        CellTable.h
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+  Description: Table with one row per triangle or tetrahedron of a data
+               set, holding the cell value, area/volume and center as
+               columns.  Can be written as text or NumPy binary files.
+
+=========================================================================*/
+
+
+#ifndef CELLTABLE_H
+#define CELLTABLE_H
+
+
+#include "BoxClipper.h"
+
+#include <vtkType.h>
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+class vtkDataSet;
+
+
+class CellTable {
+public:
+    CellTable();
+
+    // Remove all rows and set the columns
+    void Initialize(int value, const char* sizeName);
+
+    // Add a row for a triangle or tetrahedron
+    void AddSimplex(const Simplex& s);
+
+    // Append the rows of another table with the same columns
+    void Add(const CellTable& other);
+
+    // Compute a row for each triangle or tetrahedron of the data, with the
+    // average of the given simplex value over its points, its area/volume
+    // and its center.  sizeName is the name of the area/volume column.
+    // Replaces any current rows.
+    void Compute(vtkDataSet* data, int value, const char* sizeName);
+
+    vtkIdType GetNumberOfRows();
+    int GetNumberOfColumns();
+
+    const std::string& GetColumnName(int column);
+    const std::vector<double>& GetColumn(int column);
+
+    // Write the table, with the format chosen from the file extension:
+    // .npy, .npz, gzip compressed text for .gz, or comma-separated text
+    // for anything else
+    bool Write(const char* fileName);
+
+    // Comma-separated text with a header line, formatted in parallel
+    bool WriteText(const char* fileName, bool compress = false);
+
+    // NumPy structured array with a named field for each column
+    bool WriteNpy(const char* fileName);
+
+    // NumPy archive with one array per column, as written by numpy.savez()
+    bool WriteNpz(const char* fileName);
+
+    // Pieces of WriteNpy(), for writing several tables to one file.  The
+    // header is padded to at least minLength, so it can be rewritten with
+    // the final number of rows.
+    std::string NpyDescription();
+    std::string NpyHeader(const std::string& descr, vtkIdType numRows, size_t minLength = 0);
+    void WriteNpyRows(std::ostream& out);
+
+protected:
+    int simplexValue;
+
+    std::vector<std::string> names;
+    std::vector< std::vector<double> > columns;
+};
+
+
+#endif
@@ -0,0 +1,555 @@
+/*=========================================================================
+
+  Name:        ColorMap.cpp
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+  Description: Color maps defined as static tables of control points, 
+               with a lookup table for mapping scalars to colors without 
+               going through vtkColorTransferFunction for each value.
+
+=========================================================================*/
+
+
+#include "ColorMap.h"
+
+#include <vtkColorTransferFunction.h>
+#include <vtkDataArray.h>
+#include <vtkUnsignedCharArray.h>
+
+#include <algorithm>
+#include <iostream>
+
+#include <math.h>
+#include <string.h>
+
+
+// How control point coordinates map to data values
+enum Scaling {
+    // 0 to 1 from the minimum to the maximum
+    LinearScaling,
+
+    // 0 to 1 from 0 to 360 degrees
+    AngleScaling,
+
+    // -1 to 1, with negative values scaled by the minimum and positive by the maximum
+    DivergingScaling,
+
+    // -1 to 1, scaled by the larger magnitude of the minimum and maximum
+    SymmetricScaling
+};
+
+// A control point.  Points with the same coordinate make a hard edge.
+struct ColorMapPoint {
+    double x;
+    double r, g, b;
+};
+
+struct ColorMapDefinition {
+    const char* name;
+    ColorMap::Kind kind;
+    Scaling scaling;
+
+    // Hold the color of each point until the next, rather than interpolating
+    bool stepped;
+
+    int numberOfLabels;
+
+    int numberOfPoints;
+    const ColorMapPoint* points;
+};
+
+
+// Banded with luminance gradient
+static const ColorMapPoint bandedBlackBody[] = {
+    // Purple
+    { 0.0,  0.0625, 0.0, 0.25 },
+    { 0.2,  0.25, 0.0, 1.0 },
+
+    // Red
+    { 0.2,  0.25, 0.0, 0.0 },
+    { 0.4,  1.0, 0.0, 0.0 },
+
+    // Orange
+    { 0.4,  0.25, 0.125, 0.0 },
+    { 0.6,  1.0, 0.5, 0.0 },
+
+    // Yellow
+    { 0.6,  0.25, 0.25, 0.0 },
+    { 0.8,  1.0, 1.0, 0.0 },
+
+    // White
+    { 0.8,  0.25, 0.25, 0.25 },
+    { 1.0,  1.0, 1.0, 1.0 }
+};
+
+// Normal
+static const ColorMapPoint blackBody[] = {
+    { 0.0,          0.0, 0.0, 0.0 },
+    { 1.0 / 3.0,    1.0, 0.0, 0.0 },
+    { 2.0 / 3.0,    1.0, 1.0, 0.0 },
+    { 1.0,          1.0, 1.0, 1.0 }
+};
+
+// Cool
+static const ColorMapPoint coolBlackBody[] = {
+    { 0.0,          0.0, 0.0, 0.0 },
+    { 1.0 / 3.0,    0.0, 0.0, 1.0 },
+    { 2.0 / 3.0,    0.0, 1.0, 1.0 },
+    { 1.0,          1.0, 1.0, 1.0 }
+};
+
+// Normal plus some hues
+static const ColorMapPoint hueBlackBody[] = {
+    { 0.0,  0.0, 0.0, 0.25 },
+    { 0.2,  0.0, 0.25, 0.0 },
+    { 0.4,  0.5, 0.0, 0.0 },
+    { 0.6,  0.75, 0.75, 0.0 },
+    { 0.8,  0.0, 1.0, 1.0 },
+    { 1.0,  1.0, 1.0, 1.0 }
+};
+
+// Paraview-style cool to warm, sampled from the diverging color space
+static const ColorMapPoint coolToWarm[] = {
+    { 0.0,      58.0 / 255.0, 76.0 / 255.0, 193.0 / 255.0 },
+    { 0.125,    98.0 / 255.0, 130.0 / 255.0, 234.0 / 255.0 },
+    { 0.25,     141.0 / 255.0, 176.0 / 255.0, 254.0 / 255.0 },
+    { 0.375,    184.0 / 255.0, 208.0 / 255.0, 249.0 / 255.0 },
+    { 0.5,      221.0 / 255.0, 221.0 / 255.0, 221.0 / 255.0 },
+    { 0.625,    245.0 / 255.0, 196.0 / 255.0, 173.0 / 255.0 },
+    { 0.75,     244.0 / 255.0, 154.0 / 255.0, 123.0 / 255.0 },
+    { 0.875,    222.0 / 255.0, 96.0 / 255.0, 77.0 / 255.0 },
+    { 1.0,      180.0 / 255.0, 4.0 / 255.0, 38.0 / 255.0 }
+};
+
+
+// Wrapped double-ended
+static const ColorMapPoint wrappedDoubleEnded[] = {
+    { 0.0,      1.0, 1.0, 1.0 },
+    { 0.125,    0.0, 1.0, 1.0 },
+    { 0.25,     0.0, 0.5, 0.0 },
+    { 0.375,    0.0, 0.0, 0.5 },
+    { 0.5,      0.25, 0.0, 0.25 },
+    { 0.625,    0.5, 0.0, 0.0 },
+    { 0.75,     1.0, 0.5, 0.0 },
+    { 0.875,    1.0, 1.0, 0.0 },
+    { 1.0,      1.0, 1.0, 1.0 }
+};
+
+// Rainbow!!!
+static const ColorMapPoint rainbow[] = {
+    { 0.0,          0.0, 1.0, 1.0 },
+    { 1.0 / 6.0,    0.0, 0.0, 1.0 },
+    { 2.0 / 6.0,    1.0, 0.0, 1.0 },
+    { 3.0 / 6.0,    1.0, 0.0, 0.0 },
+    { 4.0 / 6.0,    1.0, 1.0, 0.0 },
+    { 5.0 / 6.0,    0.0, 1.0, 0.0 },
+    { 1.0,          0.0, 1.0, 1.0 }
+};
+
+// 4 color with luminance gradient
+static const ColorMapPoint fourColorGradient[] = {
+    // Red
+    { 0.0,      0.625, 0.0, 0.0 },
+    { 0.125,    1.0, 0.0, 0.0 },
+
+    // Green
+    { 0.125,    0.0, 0.25, 0.0 },
+    { 0.375,    0.0, 1.0, 0.0 },
+
+    // Cyan
+    { 0.375,    0.0, 0.25, 0.25 },
+    { 0.625,    0.0, 1.0, 1.0 },
+
+    // Yellow
+    { 0.625,    0.25, 0.25, 0.0 },
+    { 0.875,    1.0, 1.0, 0.0 },
+
+    // Back to red
+    { 0.875,    0.25, 0.0, 0.0 },
+    { 1.0,      0.625, 0.0, 0.0 }
+};
+
+// 8 colors with 2 luminance bands each
+static const ColorMapPoint eightColorBands[] = {
+    { 0.0,      0.5, 0.0, 0.0 },
+    { 0.0625,   1.0, 0.0, 0.0 },
+    { 0.125,    0.5, 0.25, 0.0 },
+    { 0.1875,   1.0, 0.5, 0.0 },
+    { 0.25,     0.5, 0.5, 0.0 },
+    { 0.3125,   1.0, 1.0, 0.0 },
+    { 0.375,    0.5, 0.5, 0.5 },
+    { 0.4375,   1.0, 1.0, 1.0 },
+    { 0.5,      0.0, 0.5, 0.0 },
+    { 0.5625,   0.0, 1.0, 0.0 },
+    { 0.625,    0.0, 0.5, 0.5 },
+    { 0.6875,   0.0, 1.0, 1.0 },
+    { 0.75,     0.0, 0.0, 0.5 },
+    { 0.8125,   0.0, 0.0, 1.0 },
+    { 0.875,    0.5, 0.0, 0.5 },
+    { 0.9375,   1.0, 0.0, 1.0 },
+    { 1.0,      0.5, 0.0, 0.0 }
+};
+
+// 4 color
+static const ColorMapPoint fourColor[] = {
+    { 0.0,  1.0, 0.0, 0.0 },
+    { 0.25, 0.0, 1.0, 0.0 },
+    { 0.5,  0.0, 0.0, 1.0 },
+    { 0.75, 1.0, 1.0, 0.0 },
+    { 1.0,  1.0, 0.0, 0.0 }
+};
+
+
+// Double-ended based on black-body
+static const ColorMapPoint doubleEndedBlackBody[] = {
+    { -1.0,     0.75, 1.0, 1.0 },
+    { -0.75,    0.0, 1.0, 1.0 },
+    { -0.1,     0.0, 0.0, 0.5 },
+    { 0.0,      0.1, 0.1, 0.1 },
+    { 0.1,      0.5, 0.0, 0.0 },
+    { 0.75,     1.0, 1.0, 0.0 },
+    { 1.0,      1.0, 1.0, 0.75 }
+};
+
+// Blue to red through gray, with the same saturation for the same magnitude
+static const ColorMapPoint blueToRed[] = {
+    { -1.0, 0.0, 0.0, 1.0 },
+    { 0.0,  0.5, 0.5, 0.5 },
+    { 1.0,  1.0, 0.0, 0.0 }
+};
+
+
+#define POINTS(p) sizeof(p) / sizeof(ColorMapPoint), p
+
+static const ColorMapDefinition colorMaps[] = {
+    { "Banded Black-Body",          ColorMap::Sequential,   LinearScaling,      false,  6,  POINTS(bandedBlackBody) },
+    { "Black-Body",                 ColorMap::Sequential,   LinearScaling,      false,  6,  POINTS(blackBody) },
+    { "Cool Black-Body",            ColorMap::Sequential,   LinearScaling,      false,  6,  POINTS(coolBlackBody) },
+    { "Black-Body with Hues",       ColorMap::Sequential,   LinearScaling,      false,  6,  POINTS(hueBlackBody) },
+    { "Cool to Warm",               ColorMap::Sequential,   LinearScaling,      false,  5,  POINTS(coolToWarm) },
+
+    { "Wrapped Double-Ended",       ColorMap::Circular,     AngleScaling,       false,  9,  POINTS(wrappedDoubleEnded) },
+    { "Rainbow",                    ColorMap::Circular,     AngleScaling,       false,  7,  POINTS(rainbow) },
+    { "Four Color Gradient",        ColorMap::Circular,     AngleScaling,       false,  9,  POINTS(fourColorGradient) },
+    { "Eight Color Bands",          ColorMap::Circular,     AngleScaling,       true,   9,  POINTS(eightColorBands) },
+    { "Four Color",                 ColorMap::Circular,     AngleScaling,       false,  5,  POINTS(fourColor) },
+
+    { "Double-Ended Black-Body",    ColorMap::Diverging,    DivergingScaling,   false,  5,  POINTS(doubleEndedBlackBody) },
+    { "Blue to Red",                ColorMap::Diverging,    SymmetricScaling,   false,  5,  POINTS(blueToRed) }
+};
+
+#undef POINTS
+
+static const int numberOfColorMaps = sizeof(colorMaps) / sizeof(ColorMapDefinition);
+
+
+// Entries in the lookup table for mapping scalars
+static const int lookupTableSize = 4096;
+
+// Values mapped at a time, so computing the lookup table indices can be vectorized
+static const int blockSize = 256;
+
+// Data units between the points of a hard edge in a transfer function
+static const double edgeStep = 0.001;
+
+
+ColorMap::ColorMap() {
+    map = 0;
+    range[0] = 0.0;
+    range[1] = 1.0;
+    lookupRange[0] = lookupRange[1] = 0.0;
+}
+
+
+int ColorMap::GetNumberOfColorMaps() {
+    return numberOfColorMaps;
+}
+
+const char* ColorMap::GetName(int which) {
+    return colorMaps[which].name;
+}
+
+ColorMap::Kind ColorMap::GetKind(int which) {
+    return colorMaps[which].kind;
+}
+
+int ColorMap::GetDefault(Kind kind) {
+    for (int i = 0; i < numberOfColorMaps; i++) {
+        if (colorMaps[i].kind == kind) return i;
+    }
+
+    return 0;
+}
+
+
+void ColorMap::SetColorMap(int which) {
+    if (which < 0 || which >= numberOfColorMaps) {
+        std::cout << "Invalid color map " << which << std::endl;
+        return;
+    }
+
+    if (which == map) return;
+
+    map = which;
+    lookupTable.clear();
+}
+
+int ColorMap::GetColorMap() {
+    return map;
+}
+
+
+void ColorMap::SetRange(double min, double max) {
+    if (min == range[0] && max == range[1]) return;
+
+    range[0] = min;
+    range[1] = max;
+    lookupTable.clear();
+}
+
+
+void ColorMap::SetEqualization(const std::vector<double>& values) {
+    if (values == equalization) return;
+
+    equalization = values.size() >= 2 ? values : std::vector<double>();
+    lookupTable.clear();
+}
+
+
+void ColorMap::GetColor(double value, double rgb[3]) {
+    GetColorAtCoordinate(GetCoordinate(value), rgb);
+}
+
+
+void ColorMap::GetTable(double v1, double v2, int n, int numComponents, unsigned char* table) {
+    double step = (v2 - v1) / n;
+
+    for (int i = 0; i < n; i++) {
+        double rgb[3];
+        GetColor(v1 + (i + 0.5) * step, rgb);
+
+        for (int j = 0; j < 3; j++) {
+            *table++ = (unsigned char)(rgb[j] * 255.0 + 0.5);
+        }
+        if (numComponents == 4) *table++ = 255;
+    }
+}
+
+
+void ColorMap::Apply(vtkColorTransferFunction* function) {
+    const ColorMapDefinition& def = colorMaps[map];
+
+    function->RemoveAllPoints();
+
+    double previous = 0.0;
+    for (int i = 0; i < def.numberOfPoints; i++) {
+        const ColorMapPoint& p = def.points[i];
+
+        // Inverse of GetCoordinate()
+        double v;
+        switch (def.scaling) {
+            case AngleScaling:
+                v = p.x * 360.0;
+                break;
+
+            case DivergingScaling:
+                v = p.x < 0.0 ? p.x * -range[0] : p.x * range[1];
+                break;
+
+            case SymmetricScaling:
+                v = p.x * (fabs(range[0]) > fabs(range[1]) ? fabs(range[0]) : fabs(range[1]));
+                break;
+
+            default:
+                if (!equalization.empty()) {
+                    double e = p.x * (equalization.size() - 1);
+                    int j = (int)e;
+                    j = j >= (int)equalization.size() - 1 ? (int)equalization.size() - 2 : j;
+                    v = equalization[j] + (equalization[j + 1] - equalization[j]) * (e - j);
+                }
+                else {
+                    v = range[0] + p.x * (range[1] - range[0]);
+                }
+                break;
+        }
+
+        // Separate the points of a hard edge
+        if (i > 0 && p.x == def.points[i - 1].x) v = previous + edgeStep;
+        previous = v;
+
+        if (def.stepped) {
+            function->AddRGBPoint(v, p.r, p.g, p.b, 0.0, 1.0);
+        }
+        else {
+            function->AddRGBPoint(v, p.r, p.g, p.b);
+        }
+    }
+}
+
+
+int ColorMap::GetNumberOfLabels() {
+    return colorMaps[map].numberOfLabels;
+}
+
+
+template <class T>
+static void MapValues(const T* values, int n, double lookupMin, double lookupScale, 
+                      const unsigned char* lookupTable, unsigned char* rgba) {
+    int index[blockSize];
+
+    // Independent arithmetic on each value, which the compiler can vectorize
+    double maxIndex = lookupTableSize - 1;
+    for (int i = 0; i < n; i++) {
+        double x = (values[i] - lookupMin) * lookupScale;
+        x = x < 0.0 ? 0.0 : x;
+        x = x > maxIndex ? maxIndex : x;
+        index[i] = (int)x;
+    }
+
+    for (int i = 0; i < n; i++) {
+        memcpy(rgba + i * 4, lookupTable + index[i] * 4, 4);
+    }
+}
+
+vtkUnsignedCharArray* ColorMap::MapScalars(vtkDataArray* scalars) {
+    UpdateLookupTable();
+
+    vtkIdType numValues = scalars->GetNumberOfTuples();
+
+    vtkUnsignedCharArray* colors = vtkUnsignedCharArray::New();
+    colors->SetName("Colors");
+    colors->SetNumberOfComponents(4);
+    colors->SetNumberOfTuples(numValues);
+    unsigned char* rgba = colors->GetPointer(0);
+
+    double lookupScale = lookupRange[1] > lookupRange[0] ? lookupTableSize / (lookupRange[1] - lookupRange[0]) : 0.0;
+    const unsigned char* table = &lookupTable[0];
+
+    // Read float and double arrays directly, and copy others a block at a time
+    double block[blockSize];
+    for (vtkIdType i = 0; i < numValues; i += blockSize) {
+        int n = numValues - i < blockSize ? (int)(numValues - i) : blockSize;
+
+        if (scalars->GetNumberOfComponents() == 1 && scalars->GetDataType() == VTK_FLOAT) {
+            const float* values = static_cast<const float*>(scalars->GetVoidPointer(i));
+            MapValues(values, n, lookupRange[0], lookupScale, table, rgba + i * 4);
+        }
+        else if (scalars->GetNumberOfComponents() == 1 && scalars->GetDataType() == VTK_DOUBLE) {
+            const double* values = static_cast<const double*>(scalars->GetVoidPointer(i));
+            MapValues(values, n, lookupRange[0], lookupScale, table, rgba + i * 4);
+        }
+        else {
+            for (int j = 0; j < n; j++) {
+                block[j] = scalars->GetComponent(i + j, 0);
+            }
+            MapValues(block, n, lookupRange[0], lookupScale, table, rgba + i * 4);
+        }
+    }
+
+    return colors;
+}
+
+
+double ColorMap::GetCoordinate(double value) {
+    switch (colorMaps[map].scaling) {
+        case AngleScaling:
+            return value / 360.0;
+
+        case DivergingScaling:
+            if (value < 0.0) {
+                return range[0] < 0.0 ? value / -range[0] : -1.0;
+            }
+            return range[1] > 0.0 ? value / range[1] : 1.0;
+
+        case SymmetricScaling: {
+            double m = fabs(range[0]) > fabs(range[1]) ? fabs(range[0]) : fabs(range[1]);
+            return m > 0.0 ? value / m : 0.0;
+        }
+
+        default:
+            if (!equalization.empty()) {
+                // Segment containing the value, evenly spaced in coordinate
+                int n = (int)equalization.size();
+                if (value <= equalization[0]) return 0.0;
+                if (value >= equalization[n - 1]) return 1.0;
+
+                int i = (int)(std::upper_bound(equalization.begin(), equalization.end(), value) - equalization.begin()) - 1;
+                double width = equalization[i + 1] - equalization[i];
+                double t = width > 0.0 ? (value - equalization[i]) / width : 0.0;
+
+                return (i + t) / (n - 1);
+            }
+            return range[1] > range[0] ? (value - range[0]) / (range[1] - range[0]) : 0.0;
+    }
+}
+
+void ColorMap::GetColorAtCoordinate(double x, double rgb[3]) {
+    const ColorMapDefinition& def = colorMaps[map];
+    const ColorMapPoint* p = def.points;
+    int last = def.numberOfPoints - 1;
+
+    // Clamp to the end points
+    if (x <= p[0].x) {
+        rgb[0] = p[0].r;
+        rgb[1] = p[0].g;
+        rgb[2] = p[0].b;
+        return;
+    }
+    if (x >= p[last].x) {
+        rgb[0] = p[last].r;
+        rgb[1] = p[last].g;
+        rgb[2] = p[last].b;
+        return;
+    }
+
+    int i = 0;
+
+    if (def.stepped) {
+        // Each step has the color of the point ending it, as with
+        // vtkColorTransferFunction points with midpoint 0 and sharpness 1
+        while (i < last - 1 && x > p[i + 1].x) i++;
+
+        rgb[0] = p[i + 1].r;
+        rgb[1] = p[i + 1].g;
+        rgb[2] = p[i + 1].b;
+        return;
+    }
+
+    // Segment containing x, taking the later segment at a hard edge
+    while (i < last - 1 && x >= p[i + 1].x) i++;
+
+    double t = (x - p[i].x) / (p[i + 1].x - p[i].x);
+    rgb[0] = p[i].r + (p[i + 1].r - p[i].r) * t;
+    rgb[1] = p[i].g + (p[i + 1].g - p[i].g) * t;
+    rgb[2] = p[i].b + (p[i + 1].b - p[i].b) * t;
+}
+
+void ColorMap::GetLookupRange(double lookup[2]) {
+    // Values beyond the data range are clamped to the end colors
+    if (colorMaps[map].scaling == AngleScaling) {
+        lookup[0] = 0.0;
+        lookup[1] = 360.0;
+    }
+    else {
+        lookup[0] = range[0];
+        lookup[1] = range[1];
+    }
+}
+
+void ColorMap::UpdateLookupTable() {
+    if (!lookupTable.empty()) return;
+
+    GetLookupRange(lookupRange);
+
+    lookupTable.resize(lookupTableSize * 4);
+    GetTable(lookupRange[0], lookupRange[1], lookupTableSize, 4, &lookupTable[0]);
+}
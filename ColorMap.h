@@ -0,0 +1,98 @@
+/*=========================================================================
+
+  Name:        ColorMap.h
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+  Description: Color maps defined as static tables of control points, 
+               with a lookup table for mapping scalars to colors without 
+               going through vtkColorTransferFunction for each value.
+
+=========================================================================*/
+
+
+#ifndef COLORMAP_H
+#define COLORMAP_H
+
+
+#include <vtkType.h>
+
+#include <vector>
+
+class vtkColorTransferFunction;
+class vtkDataArray;
+class vtkUnsignedCharArray;
+
+
+class ColorMap {
+public:
+    ColorMap();
+
+    // Which data each color map is meant for
+    enum Kind {
+        Sequential,
+        Circular,
+        Diverging
+    };
+
+    // The available color maps
+    static int GetNumberOfColorMaps();
+    static const char* GetName(int map);
+    static Kind GetKind(int map);
+
+    // The first color map of each kind is the default
+    static int GetDefault(Kind kind);
+
+    void SetColorMap(int map);
+    int GetColorMap();
+
+    // Data range the color map spans.  Circular color maps always span 0 to 360,
+    // and diverging color maps are centered on 0.
+    void SetRange(double min, double max);
+
+    // Spread the coordinates of sequential color maps evenly over these increasing
+    // values, rather than over the range, e.g. quantiles to equalize the colors.
+    // Pass an empty vector to go back to linear.
+    void SetEqualization(const std::vector<double>& values);
+
+    // Color for a value
+    void GetColor(double value, double rgb[3]);
+
+    // Sample the color map at the centers of n equal steps from v1 to v2,
+    // with 3 (RGB) or 4 (RGBA) components per entry
+    void GetTable(double v1, double v2, int n, int numComponents, unsigned char* table);
+
+    // Set the control points of a transfer function, e.g. for the legend
+    void Apply(vtkColorTransferFunction* function);
+
+    // Good number of legend labels for the color map
+    int GetNumberOfLabels();
+
+    // Map single-component scalars to RGBA colors
+    vtkUnsignedCharArray* MapScalars(vtkDataArray* scalars);
+
+protected:
+    int map;
+    double range[2];
+    std::vector<double> equalization;
+
+    // Lookup table for mapping scalars, rebuilt when the map or range changes
+    std::vector<unsigned char> lookupTable;
+    double lookupRange[2];
+
+    double GetCoordinate(double value);
+    void GetColorAtCoordinate(double x, double rgb[3]);
+    void GetLookupRange(double lookup[2]);
+    void UpdateLookupTable();
+};
+
+
+#endif
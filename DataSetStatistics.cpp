@@ -0,0 +1,108 @@
+/*=========================================================================
+
+  Name:        DataSetStatistics.cpp
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+  Description: Computes statistics of all cells of a data set in one 
+               multithreaded pass.
+
+=========================================================================*/
+
+
+#include "DataSetStatistics.h"
+
+#include "BoxClipper.h"
+#include "SimplexReader.h"
+
+#include <vtkDataSet.h>
+
+
+DataSetStatistics::DataSetStatistics() {
+    input = NULL;
+    abort = false;
+}
+
+DataSetStatistics::~DataSetStatistics() {
+}
+
+
+void DataSetStatistics::SetInput(vtkDataSet* data) {
+    input = data;
+}
+
+
+void DataSetStatistics::Update() {
+    statistics.Initialize();
+
+    if (input == NULL || input->GetNumberOfCells() == 0) return;
+
+    // Make the data safe to read from multiple threads
+    SimplexReader::Prepare(input);
+
+    vtkMultiThreader* threader = vtkMultiThreader::New();
+    threadStatistics.assign(threader->GetNumberOfThreads(), RegionStatistics());
+    threader->SetSingleMethod(ThreadFunction, this);
+    threader->SingleMethodExecute();
+    threader->Delete();
+
+    // Combine the results from each thread
+    for (int i = 0; i < (int)threadStatistics.size(); i++) {
+        statistics.Add(threadStatistics[i]);
+    }
+
+    threadStatistics.clear();
+}
+
+
+void DataSetStatistics::SetAbort(bool stop) {
+    abort = stop;
+}
+
+bool DataSetStatistics::GetAbort() {
+    return abort;
+}
+
+
+RegionStatistics& DataSetStatistics::GetStatistics() {
+    return statistics;
+}
+
+
+VTK_THREAD_RETURN_TYPE DataSetStatistics::ThreadFunction(void* arg) {
+    vtkMultiThreader::ThreadInfo* info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+    DataSetStatistics* self = static_cast<DataSetStatistics*>(info->UserData);
+
+    self->ThreadExecute(info->ThreadID, info->NumberOfThreads);
+
+    return VTK_THREAD_RETURN_VALUE;
+}
+
+void DataSetStatistics::ThreadExecute(int thread, int numThreads) {
+    RegionStatistics& stats = threadStatistics[thread];
+
+    SimplexReader reader(input);
+
+    std::vector<Simplex> simplices;
+
+    vtkIdType numCells = input->GetNumberOfCells();
+    vtkIdType start = numCells * thread / numThreads;
+    vtkIdType end = numCells * (thread + 1) / numThreads;
+
+    for (vtkIdType cellId = start; cellId < end && !abort; cellId++) {
+        simplices.clear();
+        reader.GetSimplices(cellId, simplices);
+
+        for (int i = 0; i < (int)simplices.size(); i++) {
+            stats.AddSimplex(simplices[i], BoxClipper::ComputeMeasure(simplices[i]));
+        }
+    }
+}
@@ -0,0 +1,65 @@
+/*=========================================================================
+
+  Name:        DataSetStatistics.h
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+  Description: Computes statistics of all cells of a data set in one 
+               multithreaded pass.
+
+=========================================================================*/
+
+
+#ifndef DATASETSTATISTICS_H
+#define DATASETSTATISTICS_H
+
+
+#include "RegionStatistics.h"
+
+#include <vtkMultiThreader.h>
+
+#include <vector>
+
+class vtkDataSet;
+
+
+class DataSetStatistics {
+public:
+    DataSetStatistics();
+    ~DataSetStatistics();
+
+    void SetInput(vtkDataSet* data);
+
+    // Compute the statistics, replacing any current values
+    void Update();
+
+    // Stop an Update() running in another thread as soon as possible.
+    // The flag is not reset by Update(), so clear it before starting.
+    void SetAbort(bool stop);
+    bool GetAbort();
+
+    RegionStatistics& GetStatistics();
+
+protected:
+    vtkDataSet* input;
+    volatile bool abort;
+
+    RegionStatistics statistics;
+
+    // Per-thread results
+    std::vector<RegionStatistics> threadStatistics;
+
+    static VTK_THREAD_RETURN_TYPE ThreadFunction(void* arg);
+    void ThreadExecute(int thread, int numThreads);
+};
+
+
+#endif
@@ -0,0 +1,317 @@
+/*=========================================================================
+
+  Name:        JSONValue.cpp
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+  Description: A minimal JSON parser for job files.  Values are read 
+               into a tree of JSONValues; objects keep their members 
+               in file order.
+
+=========================================================================*/
+
+
+#include "JSONValue.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include <stdlib.h>
+#include <string.h>
+
+
+// Limit on nesting, so bad input can't exhaust the stack
+static const int maxDepth = 256;
+
+
+struct JSONValue::ParseState {
+    const char* p;
+    const char* end;
+    int line;
+    int depth;
+
+    void SkipSpace() {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) {
+            if (*p == '\n') line++;
+            p++;
+        }
+    }
+
+    bool Match(const char* word) {
+        size_t n = strlen(word);
+        if ((size_t)(end - p) < n || strncmp(p, word, n) != 0) return false;
+        p += n;
+        return true;
+    }
+
+    bool Error(const char* message) {
+        std::cout << "JSON error on line " << line << ": " << message << std::endl;
+        return false;
+    }
+};
+
+
+JSONValue::JSONValue() {
+    type = Null;
+    boolean = false;
+    number = 0.0;
+}
+
+
+bool JSONValue::Parse(const std::string& text) {
+    ParseState state;
+    state.p = text.c_str();
+    state.end = state.p + text.size();
+    state.line = 1;
+    state.depth = 0;
+
+    if (!ParseValue(state)) {
+        *this = JSONValue();
+        return false;
+    }
+
+    state.SkipSpace();
+    if (state.p != state.end) {
+        *this = JSONValue();
+        return state.Error("Unexpected text after value");
+    }
+
+    return true;
+}
+
+bool JSONValue::ReadFile(const char* fileName) {
+    std::ifstream file;
+    file.open(fileName, std::ios::binary);
+
+    if (!file.good()) {
+        std::cout << "Could not open " << fileName << " for reading" << std::endl;
+        return false;
+    }
+
+    std::stringstream text;
+    text << file.rdbuf();
+    file.close();
+
+    return Parse(text.str());
+}
+
+
+JSONValue::Type JSONValue::GetType() const {
+    return type;
+}
+
+
+bool JSONValue::GetBoolean() const {
+    return boolean;
+}
+
+double JSONValue::GetNumber() const {
+    return number;
+}
+
+const std::string& JSONValue::GetString() const {
+    return string;
+}
+
+
+int JSONValue::GetSize() const {
+    return (int)elements.size();
+}
+
+const JSONValue& JSONValue::GetElement(int i) const {
+    return elements[i];
+}
+
+
+const JSONValue* JSONValue::GetMember(const char* name) const {
+    if (type != Object) return NULL;
+
+    // Last one wins for duplicate names
+    for (int i = (int)names.size() - 1; i >= 0; i--) {
+        if (names[i] == name) return &elements[i];
+    }
+
+    return NULL;
+}
+
+const std::string& JSONValue::GetMemberName(int i) const {
+    return names[i];
+}
+
+
+bool JSONValue::ParseValue(ParseState& state) {
+    state.SkipSpace();
+    if (state.p == state.end) return state.Error("Unexpected end of text");
+
+    char c = *state.p;
+
+    if (c == '{' || c == '[') {
+        if (++state.depth > maxDepth) return state.Error("Nested too deeply");
+
+        bool object = c == '{';
+        char close = object ? '}' : ']';
+
+        type = object ? Object : Array;
+        state.p++;
+
+        state.SkipSpace();
+        if (state.p < state.end && *state.p == close) {
+            state.p++;
+            state.depth--;
+            return true;
+        }
+
+        while (true) {
+            if (object) {
+                state.SkipSpace();
+                if (state.p == state.end || *state.p != '"') return state.Error("Expected member name");
+
+                std::string name;
+                if (!ParseString(state, name)) return false;
+                names.push_back(name);
+
+                state.SkipSpace();
+                if (state.p == state.end || *state.p != ':') return state.Error("Expected ':'");
+                state.p++;
+            }
+
+            elements.push_back(JSONValue());
+            if (!elements.back().ParseValue(state)) return false;
+
+            state.SkipSpace();
+            if (state.p == state.end) return state.Error("Unexpected end of text");
+
+            if (*state.p == ',') {
+                state.p++;
+            }
+            else if (*state.p == close) {
+                state.p++;
+                break;
+            }
+            else {
+                return state.Error(object ? "Expected ',' or '}'" : "Expected ',' or ']'");
+            }
+        }
+
+        state.depth--;
+        return true;
+    }
+
+    if (c == '"') {
+        type = String;
+        return ParseString(state, string);
+    }
+
+    if (state.Match("true")) {
+        type = Boolean;
+        boolean = true;
+        return true;
+    }
+
+    if (state.Match("false")) {
+        type = Boolean;
+        boolean = false;
+        return true;
+    }
+
+    if (state.Match("null")) {
+        type = Null;
+        return true;
+    }
+
+    if (c == '-' || (c >= '0' && c <= '9')) {
+        // Copy the number, as the text isn't null terminated at its end
+        const char* start = state.p;
+        while (state.p < state.end && strchr("+-.eE0123456789", *state.p)) state.p++;
+
+        std::string s(start, state.p);
+        char* numberEnd;
+        number = strtod(s.c_str(), &numberEnd);
+        if (numberEnd != s.c_str() + s.size()) return state.Error("Invalid number");
+
+        type = Number;
+        return true;
+    }
+
+    return state.Error("Unexpected character");
+}
+
+bool JSONValue::ParseString(ParseState& state, std::string& s) {
+    // Skip the opening quote
+    state.p++;
+
+    s.clear();
+
+    while (state.p < state.end && *state.p != '"') {
+        char c = *state.p++;
+
+        if (c == '\n') return state.Error("Unterminated string");
+
+        if (c != '\\') {
+            s += c;
+            continue;
+        }
+
+        if (state.p == state.end) break;
+
+        c = *state.p++;
+        switch (c) {
+            case '"':
+            case '\\':
+            case '/':
+                s += c;
+                break;
+
+            case 'b': s += '\b'; break;
+            case 'f': s += '\f'; break;
+            case 'n': s += '\n'; break;
+            case 'r': s += '\r'; break;
+            case 't': s += '\t'; break;
+
+            case 'u': {
+                if (state.end - state.p < 4) return state.Error("Invalid escape");
+
+                std::string hex(state.p, state.p + 4);
+                char* hexEnd;
+                unsigned long code = strtoul(hex.c_str(), &hexEnd, 16);
+                if (hexEnd != hex.c_str() + 4) return state.Error("Invalid escape");
+                state.p += 4;
+
+                // Encode as UTF-8.  Surrogate pairs aren't combined, which
+                // is fine for file names and keys.
+                if (code < 0x80) {
+                    s += (char)code;
+                }
+                else if (code < 0x800) {
+                    s += (char)(0xC0 | (code >> 6));
+                    s += (char)(0x80 | (code & 0x3F));
+                }
+                else {
+                    s += (char)(0xE0 | (code >> 12));
+                    s += (char)(0x80 | ((code >> 6) & 0x3F));
+                    s += (char)(0x80 | (code & 0x3F));
+                }
+                break;
+            }
+
+            default:
+                return state.Error("Invalid escape");
+        }
+    }
+
+    if (state.p == state.end) return state.Error("Unterminated string");
+
+    // Skip the closing quote
+    state.p++;
+
+    return true;
+}
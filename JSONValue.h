@@ -0,0 +1,78 @@
+/*=========================================================================
+
+  Name:        JSONValue.h
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+  Description: A minimal JSON parser for job files.  Values are read 
+               into a tree of JSONValues; objects keep their members 
+               in file order.
+
+=========================================================================*/
+
+
+#ifndef JSONVALUE_H
+#define JSONVALUE_H
+
+
+#include <string>
+#include <vector>
+
+
+class JSONValue {
+public:
+    enum Type {
+        Null,
+        Boolean,
+        Number,
+        String,
+        Array,
+        Object
+    };
+
+    JSONValue();
+
+    // Parse JSON text, replacing this value.  Errors are printed with 
+    // the line number.
+    bool Parse(const std::string& text);
+    bool ReadFile(const char* fileName);
+
+    Type GetType() const;
+
+    bool GetBoolean() const;
+    double GetNumber() const;
+    const std::string& GetString() const;
+
+    // Number of array elements or object members
+    int GetSize() const;
+    const JSONValue& GetElement(int i) const;
+
+    // Object member, or NULL if not present
+    const JSONValue* GetMember(const char* name) const;
+    const std::string& GetMemberName(int i) const;
+
+protected:
+    Type type;
+    bool boolean;
+    double number;
+    std::string string;
+
+    // Array elements or object members, with names for objects
+    std::vector<JSONValue> elements;
+    std::vector<std::string> names;
+
+    struct ParseState;
+    bool ParseValue(ParseState& state);
+    static bool ParseString(ParseState& state, std::string& s);
+};
+
+
+#endif
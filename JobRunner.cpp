@@ -0,0 +1,390 @@
+/*=========================================================================
+
+  Name:        JobRunner.cpp
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+  Description: Runs the jobs in a JSON job file with an offscreen 
+               pipeline, without the GUI.  Data files are loaded once
+               and kept for all jobs that use them.
+
+=========================================================================*/
+
+
+#include "JobRunner.h"
+
+#include "JSONValue.h"
+#include "RegionStatistics.h"
+#include "VTKPipeline.h"
+
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+
+// Screenshot size if not given in the job file
+static const int defaultWidth = 1024;
+static const int defaultHeight = 768;
+
+
+// Get an optional string member.  Returns false if it is not a string.
+static bool GetString(const JSONValue& value, const char* name, std::string& s) {
+    s.clear();
+
+    const JSONValue* member = value.GetMember(name);
+    if (member == NULL) return true;
+
+    if (member->GetType() != JSONValue::String) {
+        std::cout << "Expected a string for \"" << name << "\"" << std::endl;
+        return false;
+    }
+
+    s = member->GetString();
+
+    return true;
+}
+
+// Get an optional array of strings.  A single string is also accepted.
+static bool GetStringList(const JSONValue& value, const char* name, std::vector<std::string>& list) {
+    list.clear();
+
+    const JSONValue* member = value.GetMember(name);
+    if (member == NULL) return true;
+
+    if (member->GetType() == JSONValue::String) {
+        list.push_back(member->GetString());
+        return true;
+    }
+
+    if (member->GetType() == JSONValue::Array) {
+        for (int i = 0; i < member->GetSize(); i++) {
+            if (member->GetElement(i).GetType() != JSONValue::String) break;
+
+            list.push_back(member->GetElement(i).GetString());
+        }
+
+        if ((int)list.size() == member->GetSize()) return true;
+    }
+
+    std::cout << "Expected a list of file names for \"" << name << "\"" << std::endl;
+    return false;
+}
+
+// Get an optional number
+static bool GetNumber(const JSONValue& value, const char* name, double& number) {
+    const JSONValue* member = value.GetMember(name);
+    if (member == NULL) return true;
+
+    if (member->GetType() != JSONValue::Number) {
+        std::cout << "Expected a number for \"" << name << "\"" << std::endl;
+        return false;
+    }
+
+    number = member->GetNumber();
+
+    return true;
+}
+
+static bool CanRead(const std::string& fileName) {
+    std::ifstream file;
+    file.open(fileName.c_str());
+
+    if (!file.good()) {
+        std::cout << "Could not open " << fileName << " for reading" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+// File name without the directory or extension
+static std::string BaseName(const std::string& fileName) {
+    std::string::size_type slash = fileName.find_last_of("/\\");
+    std::string name = slash == std::string::npos ? fileName : fileName.substr(slash + 1);
+
+    std::string::size_type dot = name.find_last_of('.');
+    return dot == std::string::npos || dot == 0 ? name : name.substr(0, dot);
+}
+
+
+JobRunner::JobRunner() {
+    pipeline = NULL;
+}
+
+JobRunner::~JobRunner() {
+    delete pipeline;
+}
+
+
+bool JobRunner::Run(const char* jobFileName) {
+    JSONValue jobFile;
+    if (!jobFile.ReadFile(jobFileName)) return false;
+
+    if (jobFile.GetType() != JSONValue::Object) {
+        std::cout << jobFileName << " should contain an object" << std::endl;
+        return false;
+    }
+
+    double width = defaultWidth;
+    double height = defaultHeight;
+    if (!GetNumber(jobFile, "width", width) || !GetNumber(jobFile, "height", height)) return false;
+
+    if (width < 1.0 || height < 1.0) {
+        std::cout << "Invalid image size " << width << " x " << height << std::endl;
+        return false;
+    }
+
+    delete pipeline;
+    pipeline = new VTKPipeline((int)width, (int)height);
+    meshFileName.clear();
+    roofOffsetFileName.clear();
+
+    // Load the data used by all jobs
+    if (!OpenData(jobFile)) return false;
+
+    std::string building;
+    if (!GetString(jobFile, "building", building)) return false;
+
+    if (!building.empty()) {
+        if (!CanRead(building)) return false;
+
+        pipeline->OpenBuildingFile(building.c_str());
+    }
+
+    const JSONValue* jobs = jobFile.GetMember("jobs");
+    if (jobs == NULL) jobs = &jobFile;
+    else if (jobs->GetType() != JSONValue::Array) {
+        std::cout << "Expected a list of jobs for \"jobs\"" << std::endl;
+        return false;
+    }
+
+    // Jobs are run in order on the one pipeline, so the data is shared.  Each
+    // job uses all threads for clipping and statistics, and exports and 
+    // screenshots are written in the background while the next one is computed.
+    bool success = true;
+    int numJobs = jobs->GetType() == JSONValue::Array ? jobs->GetSize() : 1;
+    for (int i = 0; i < numJobs; i++) {
+        const JSONValue& job = jobs->GetType() == JSONValue::Array ? jobs->GetElement(i) : *jobs;
+
+        std::cout << "Running job " << i + 1 << " of " << numJobs << std::endl;
+
+        if (job.GetType() != JSONValue::Object || !RunJob(job)) {
+            std::cout << "Job " << i + 1 << " failed" << std::endl;
+            success = false;
+        }
+    }
+
+    pipeline->FinishClip();
+    pipeline->FinishScreenshots();
+
+    return success;
+}
+
+
+bool JobRunner::OpenData(const JSONValue& value) {
+    std::string mesh;
+    std::string roofOffset;
+    if (!GetString(value, "mesh", mesh) || !GetString(value, "roofOffset", roofOffset)) return false;
+
+    // Only read files that aren't already loaded
+    if (!mesh.empty() && mesh != meshFileName) {
+        if (!CanRead(mesh)) return false;
+
+        pipeline->OpenMeshFile(mesh.c_str());
+        meshFileName = mesh;
+    }
+
+    if (!roofOffset.empty() && roofOffset != roofOffsetFileName) {
+        if (!CanRead(roofOffset)) return false;
+
+        pipeline->OpenRoofOffsetFile(roofOffset.c_str());
+        roofOffsetFileName = roofOffset;
+    }
+
+    return true;
+}
+
+
+bool JobRunner::RunJob(const JSONValue& job) {
+    if (!OpenData(job)) return false;
+
+    // Data set
+    std::string dataSet;
+    if (!GetString(job, "dataSet", dataSet)) return false;
+
+    if (dataSet == "mesh" || (dataSet.empty() && job.GetMember("mesh"))) {
+        if (!pipeline->HasMesh()) {
+            std::cout << "No mesh file loaded" << std::endl;
+            return false;
+        }
+
+        pipeline->SetDataSet(VTKPipeline::Mesh);
+    }
+    else if (dataSet == "roofOffset" || (dataSet.empty() && job.GetMember("roofOffset"))) {
+        if (!pipeline->HasRoofOffset()) {
+            std::cout << "No roof offset file loaded" << std::endl;
+            return false;
+        }
+
+        pipeline->SetDataSet(VTKPipeline::RoofOffset);
+    }
+    else if (!dataSet.empty()) {
+        std::cout << "Unknown data set " << dataSet << std::endl;
+        return false;
+    }
+
+    if (!pipeline->HasMesh() && !pipeline->HasRoofOffset()) {
+        std::cout << "No data loaded" << std::endl;
+        return false;
+    }
+
+    // Vector data
+    std::string vectorData;
+    if (!GetString(job, "vectorData", vectorData)) return false;
+
+    if (vectorData == "xyMagnitude") {
+        pipeline->SetVectorData(VTKPipeline::XYMagnitude);
+    }
+    else if (vectorData == "xyAngle") {
+        pipeline->SetVectorData(VTKPipeline::XYAngle);
+    }
+    else if (vectorData == "zComponent") {
+        pipeline->SetVectorData(VTKPipeline::ZComponent);
+    }
+    else if (!vectorData.empty()) {
+        std::cout << "Unknown vector data " << vectorData << std::endl;
+        return false;
+    }
+
+    // Outputs
+    std::vector<std::string> clips;
+    std::vector<std::string> views;
+    std::string statisticsFileName;
+    std::string exportFileName;
+    std::string screenshotFileName;
+    std::string boxFileName;
+    std::string boxStatisticsFileName;
+
+    if (!GetStringList(job, "clips", clips) ||
+        !GetStringList(job, "views", views) ||
+        !GetString(job, "statistics", statisticsFileName) ||
+        !GetString(job, "export", exportFileName) ||
+        !GetString(job, "screenshot", screenshotFileName) ||
+        !GetString(job, "boxes", boxFileName) ||
+        !GetString(job, "boxStatistics", boxStatisticsFileName)) {
+        return false;
+    }
+
+    const JSONValue* compressValue = job.GetMember("compress");
+    bool compress = compressValue && compressValue->GetType() == JSONValue::Boolean && compressValue->GetBoolean();
+
+    // Check the inputs before doing any work
+    for (int i = 0; i < (int)clips.size(); i++) {
+        if (!CanRead(clips[i])) return false;
+    }
+    for (int i = 0; i < (int)views.size(); i++) {
+        if (!CanRead(views[i])) return false;
+    }
+
+    // Statistics for a set of boxes, over the full data
+    if (!boxFileName.empty() || !boxStatisticsFileName.empty()) {
+        if (boxFileName.empty() || boxStatisticsFileName.empty()) {
+            std::cout << "Need both \"boxes\" and \"boxStatistics\"" << std::endl;
+            return false;
+        }
+
+        pipeline->SaveBatchStatistics(boxFileName.c_str(), boxStatisticsFileName.c_str());
+    }
+
+    std::ofstream statisticsFile;
+    if (!statisticsFileName.empty()) {
+        statisticsFile.open(statisticsFileName.c_str());
+
+        if (!statisticsFile.good()) {
+            std::cout << "Could not open " << statisticsFileName << " for writing" << std::endl;
+            return false;
+        }
+
+        // Write header
+        statisticsFile << "Clip, ";
+        RegionStatistics::WriteHeader(statisticsFile);
+        statisticsFile << std::endl;
+    }
+
+    std::string::size_type dot = exportFileName.find_last_of('.');
+    std::string extension = dot == std::string::npos ? "" : exportFileName.substr(dot);
+    bool xml = extension == ".vtu" || extension == ".vtp";
+
+    // Use the current clipping box if no clips are given
+    int numClips = clips.empty() ? 1 : (int)clips.size();
+    int numViews = views.empty() ? 1 : (int)views.size();
+
+    for (int i = 0; i < numClips; i++) {
+        std::string clipName;
+        if (!clips.empty()) {
+            pipeline->OpenClipSettings(clips[i].c_str());
+            clipName = BaseName(clips[i]);
+        }
+        pipeline->UpdateClipping();
+
+        // Exact statistics, so the labels in screenshots match the statistics file
+        pipeline->FinishStatistics();
+
+        if (statisticsFile.is_open()) {
+            RegionStatistics clipStatistics;
+            pipeline->ComputeClipStatistics(clipStatistics);
+
+            statisticsFile << (clipName.empty() ? "Clip" : clipName) << ", ";
+            clipStatistics.Write(statisticsFile);
+            statisticsFile << std::endl;
+        }
+
+        if (!exportFileName.empty()) {
+            std::string name = AddSuffix(exportFileName, clipName, "");
+
+            if (xml) pipeline->SaveClip(name.c_str(), compress);
+            else pipeline->SaveData(name.c_str());
+        }
+
+        if (!screenshotFileName.empty()) {
+            for (int j = 0; j < numViews; j++) {
+                std::string viewName;
+                if (!views.empty()) {
+                    pipeline->OpenCameraView(views[j].c_str());
+                    viewName = BaseName(views[j]);
+                }
+
+                pipeline->Render();
+                pipeline->SaveScreenshot(AddSuffix(screenshotFileName, clipName, viewName).c_str());
+            }
+        }
+    }
+
+    if (statisticsFile.is_open()) statisticsFile.close();
+
+    return true;
+}
+
+
+std::string JobRunner::AddSuffix(const std::string& fileName, const std::string& clipName, const std::string& viewName) {
+    std::string suffix;
+    if (!clipName.empty()) suffix += "_" + clipName;
+    if (!viewName.empty()) suffix += "_" + viewName;
+
+    // Insert before the extension, if the file name has one
+    std::string::size_type slash = fileName.find_last_of("/\\");
+    std::string::size_type dot = fileName.find_last_of('.');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        return fileName + suffix;
+    }
+
+    return fileName.substr(0, dot) + suffix + fileName.substr(dot);
+}
@@ -0,0 +1,89 @@
+/*=========================================================================
+
+  Name:        JobRunner.h
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+  Description: Runs the jobs in a JSON job file with an offscreen 
+               pipeline, without the GUI.  Data files are loaded once
+               and kept for all jobs that use them.
+
+               {
+                 "mesh": "mesh.vtu",
+                 "roofOffset": "roofOffset.vtp",
+                 "building": "buildings.stl",
+                 "width": 1024,
+                 "height": 768,
+                 "jobs": [
+                   {
+                     "dataSet": "mesh",
+                     "vectorData": "xyMagnitude",
+                     "clips": [ "box1.txt", "box2.txt" ],
+                     "views": [ "view1.txt" ],
+                     "statistics": "statistics.csv",
+                     "export": "clip.vtu",
+                     "screenshot": "view.png",
+                     "boxes": "boxes.txt",
+                     "boxStatistics": "boxStatistics.csv"
+                   }
+                 ]
+               }
+
+               All keys are optional.  Jobs can also set "mesh" and 
+               "roofOffset" to switch data files.  "dataSet" is "mesh" 
+               or "roofOffset", and "vectorData" is "xyMagnitude", 
+               "xyAngle" or "zComponent".  Clips and views are files 
+               saved with Save Clip Settings and Save Camera View.  
+
+               "statistics" is a table with a row per clip.  "export" 
+               and "screenshot" are saved for each clip, and each clip 
+               and view, with the clip and view file names added before 
+               the extension.  Exports to .vtu/.vtp are written in the 
+               background while the next clip is computed.  "boxes" and
+               "boxStatistics" work as with --statistics.
+
+=========================================================================*/
+
+
+#ifndef JOBRUNNER_H
+#define JOBRUNNER_H
+
+
+#include <string>
+
+class JSONValue;
+class VTKPipeline;
+
+
+class JobRunner {
+public:
+    JobRunner();
+    ~JobRunner();
+
+    // Run all jobs in the file.  Returns false if any job failed.
+    bool Run(const char* jobFileName);
+
+protected:
+    VTKPipeline* pipeline;
+
+    // Data files currently loaded
+    std::string meshFileName;
+    std::string roofOffsetFileName;
+
+    bool OpenData(const JSONValue& value);
+    bool RunJob(const JSONValue& job);
+
+    // Add the name of the clip or view file before the extension of the output file name
+    static std::string AddSuffix(const std::string& fileName, const std::string& clipName, const std::string& viewName);
+};
+
+
+#endif
@@ -0,0 +1,164 @@
+/*=========================================================================
+
+  Name:        LODBuilder.cpp
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+  Description: Builds a decimated copy of a surface in a background
+               thread, to render in its place during interaction.
+
+=========================================================================*/
+
+
+#include "LODBuilder.h"
+
+#include <vtkDecimatePro.h>
+#include <vtkMutexLock.h>
+#include <vtkPolyData.h>
+#include <vtkTriangleFilter.h>
+
+
+LODBuilder::LODBuilder() {
+    targetNumberOfCells = 100000;
+
+    source = NULL;
+    sourceTime = 0;
+
+    copy = NULL;
+    output = vtkPolyData::New();
+    result = NULL;
+    ready = false;
+
+    threader = vtkMultiThreader::New();
+    threadId = -1;
+    lock = vtkMutexLock::New();
+    done = false;
+}
+
+LODBuilder::~LODBuilder() {
+    if (threadId >= 0) threader->TerminateThread(threadId);
+
+    if (copy) copy->Delete();
+    if (result) result->Delete();
+    output->Delete();
+
+    threader->Delete();
+    lock->Delete();
+}
+
+
+void LODBuilder::SetTargetNumberOfCells(vtkIdType numCells) {
+    targetNumberOfCells = numCells;
+}
+
+vtkIdType LODBuilder::GetTargetNumberOfCells() {
+    return targetNumberOfCells;
+}
+
+
+void LODBuilder::Update(vtkPolyData* surface) {
+    if (threadId >= 0 || surface == NULL) return;
+
+    if (surface == source && surface->GetMTime() == sourceTime) return;
+
+    source = surface;
+    sourceTime = surface->GetMTime();
+    ready = false;
+
+    // Hold a shallow copy, so the arrays stay as they are if the pipeline
+    // updates the surface.  The thread makes its own deep copy from it.
+    copy = vtkPolyData::New();
+    copy->ShallowCopy(surface);
+
+    done = false;
+    threadId = threader->SpawnThread(ThreadFunction, this);
+}
+
+
+bool LODBuilder::Poll() {
+    if (threadId < 0) return false;
+
+    lock->Lock();
+    bool finished = done;
+    lock->Unlock();
+
+    if (!finished) return false;
+
+    threader->TerminateThread(threadId);
+    threadId = -1;
+
+    copy->Delete();
+    copy = NULL;
+
+    output->ShallowCopy(result);
+    result->Delete();
+    result = NULL;
+
+    ready = true;
+
+    return true;
+}
+
+
+bool LODBuilder::IsCurrent(vtkPolyData* surface) {
+    return ready && surface == source && surface->GetMTime() == sourceTime;
+}
+
+
+vtkPolyData* LODBuilder::GetOutput() {
+    return output;
+}
+
+
+VTK_THREAD_RETURN_TYPE LODBuilder::ThreadFunction(void* arg) {
+    vtkMultiThreader::ThreadInfo* info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+    LODBuilder* self = static_cast<LODBuilder*>(info->UserData);
+
+    self->ThreadExecute();
+
+    self->lock->Lock();
+    self->done = true;
+    self->lock->Unlock();
+
+    return VTK_THREAD_RETURN_VALUE;
+}
+
+void LODBuilder::ThreadExecute() {
+    // Copy here rather than on the main thread, as copying a large surface
+    // would stall interaction.  Reading the shared arrays is safe, but the
+    // filters would change their reference counts, which is not.
+    vtkPolyData* input = vtkPolyData::New();
+    input->DeepCopy(copy);
+
+    // Decimation only works on triangles, e.g. not the sides of the roof extrusion
+    vtkTriangleFilter* triangles = vtkTriangleFilter::New();
+    triangles->SetInput(input);
+    triangles->Update();
+
+    vtkIdType numCells = triangles->GetOutput()->GetNumberOfCells();
+    double reduction = numCells > targetNumberOfCells ? 1.0 - (double)targetNumberOfCells / numCells : 0.0;
+
+    // Keeps a subset of the original points, so point data is kept for coloring
+    vtkDecimatePro* decimate = vtkDecimatePro::New();
+    decimate->SetInputConnection(triangles->GetOutputPort());
+    decimate->SetTargetReduction(reduction);
+    decimate->PreserveTopologyOff();
+    decimate->SplittingOff();
+    decimate->BoundaryVertexDeletionOn();
+    decimate->Update();
+
+    result = vtkPolyData::New();
+    result->ShallowCopy(decimate->GetOutput());
+
+    input->Delete();
+    triangles->Delete();
+    decimate->Delete();
+}
@@ -0,0 +1,75 @@
+/*=========================================================================
+
+  Name:        LODBuilder.h
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+  Description: Builds a decimated copy of a surface in a background
+               thread, to render in its place during interaction.
+
+=========================================================================*/
+
+
+#ifndef LODBUILDER_H
+#define LODBUILDER_H
+
+
+#include <vtkMultiThreader.h>
+
+class vtkMutexLock;
+class vtkPolyData;
+
+
+class LODBuilder {
+public:
+    LODBuilder();
+    ~LODBuilder();
+
+    // Approximate number of triangles to decimate to
+    void SetTargetNumberOfCells(vtkIdType numCells);
+    vtkIdType GetTargetNumberOfCells();
+
+    // Start building from the surface if it has changed since the last
+    // build and no build is running.  Call from the main thread.
+    void Update(vtkPolyData* surface);
+
+    // Returns true once when a build has finished
+    bool Poll();
+
+    // True if the output was built from the surface as it is now
+    bool IsCurrent(vtkPolyData* surface);
+
+    vtkPolyData* GetOutput();
+
+protected:
+    vtkIdType targetNumberOfCells;
+
+    // Source of the current or last build
+    vtkPolyData* source;
+    unsigned long sourceTime;
+
+    // Shallow copy of the source, held by the main thread while building
+    vtkPolyData* copy;
+    vtkPolyData* output;
+    vtkPolyData* result;
+    bool ready;
+
+    vtkMultiThreader* threader;
+    int threadId;
+    vtkMutexLock* lock;
+    bool done;
+
+    static VTK_THREAD_RETURN_TYPE ThreadFunction(void* arg);
+    void ThreadExecute();
+};
+
+
+#endif
@@ -14,10 +14,20 @@
 
 #include <qapplication.h>
 #include <qfiledialog.h>
+#include <qfileinfo.h>
+#include <qinputdialog.h>
+#include <qmessagebox.h>
+#include <qtimer.h>
 
+#include "BoxClipper.h"
+#include "ColorMap.h"
 #include "VTKPipeline.h"
 
 
+// About one frame at 60 Hz
+static const int minimumFrameInterval = 16;
+
+
 MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent) {
     // Create the GUI from the Qt Designer file
     setupUi(this);
@@ -74,6 +84,23 @@ MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent) {
     // Create the visualization pipeline
     pipeline = new VTKPipeline(qvtkWidget->GetInteractor(), this);
 
+    // Check for statistics refined in the background
+    QTimer* statisticsTimer = new QTimer(this);
+    connect(statisticsTimer, SIGNAL(timeout()), this, SLOT(RefreshStatistics()));
+    statisticsTimer->start(100);
+
+    // Check on clips being saved and decimated data being built in the background
+    QTimer* backgroundTimer = new QTimer(this);
+    connect(backgroundTimer, SIGNAL(timeout()), this, SLOT(PollBackground()));
+    backgroundTimer->start(100);
+
+    // Single shot timer for renders requested by widgets
+    renderTimer = new QTimer(this);
+    renderTimer->setSingleShot(true);
+    connect(renderTimer, SIGNAL(timeout()), this, SLOT(RenderScheduled()));
+    renderClock.start();
+    frameTime = 0.0;
+
     // Initalize the GUI
     RefreshGUI();
 }
@@ -83,6 +110,11 @@ MainWindow::~MainWindow() {
 }
 
 
+void MainWindow::CameraChanged(const double position[3], double distance, const double orientation[4]) {
+    SetCameraPosition(position[0], position[1], position[2], distance);
+    SetCameraRotation(orientation[0], orientation[1], orientation[2], orientation[3]);
+}
+
 void MainWindow::SetCameraPosition(double x, double y, double z, double d) {
     cameraPositionXSpinBox->blockSignals(true);
     cameraPositionYSpinBox->blockSignals(true);
@@ -178,21 +210,75 @@ void MainWindow::on_actionOpenBuildingGeometry_triggered() {
 }
 
 void MainWindow::on_actionSaveData_triggered() {
-    // Open a file dialog to save the text file
+    // Open a file dialog to save the data file
+    QString filter;
     QString fileName = QFileDialog::getSaveFileName(this,
                                                     "Save Data",
                                                     "",
-                                                    "Text Files (*.txt)");
+                                                    "Text Files (*.txt);;Compressed Text Files (*.txt.gz);;NumPy Arrays (*.npy);;NumPy Column Archives (*.npz)",
+                                                    &filter);
 
     // Check for file name
     if (fileName == "") {
         return;
     }
 
-    // Save a screenshot
+    // The format is chosen from the extension, so add the selected one if missing
+    if (QFileInfo(fileName).suffix().isEmpty()) {
+        fileName += filter.section('*', 1).section(')', 0, 0);
+    }
+
+    // Save the clipped data
     pipeline->SaveData(fileName.toLatin1().constData());
 }
 
+void MainWindow::on_actionSaveFullData_triggered() {
+    // Open a file dialog to save the data file
+    QString filter;
+    QString fileName = QFileDialog::getSaveFileName(this,
+                                                    "Save Full Data",
+                                                    "",
+                                                    "Text Files (*.txt);;Compressed Text Files (*.txt.gz);;NumPy Arrays (*.npy)",
+                                                    &filter);
+
+    // Check for file name
+    if (fileName == "") {
+        return;
+    }
+
+    // The format is chosen from the extension, so add the selected one if missing
+    if (QFileInfo(fileName).suffix().isEmpty()) {
+        fileName += filter.section('*', 1).section(')', 0, 0);
+    }
+
+    // Stream all of the data to the file, without clipping
+    pipeline->StreamData(fileName.toLatin1().constData(), false);
+}
+
+void MainWindow::on_actionSaveClip_triggered() {
+    // Open a file dialog to save the VTK file
+    QString filter;
+    QString fileName = QFileDialog::getSaveFileName(this,
+                                                    "Save Clip as VTK",
+                                                    "",
+                                                    "VTK Unstructured Grid (*.vtu);;VTK Unstructured Grid, Compressed (*.vtu);;"
+                                                    "VTK Surface (*.vtp);;VTK Surface, Compressed (*.vtp)",
+                                                    &filter);
+
+    // Check for file name
+    if (fileName == "") {
+        return;
+    }
+
+    // The format is chosen from the extension, so add the selected one if missing
+    if (QFileInfo(fileName).suffix().isEmpty()) {
+        fileName += filter.section('*', 1).section(')', 0, 0);
+    }
+
+    // Written in the background
+    pipeline->SaveClip(fileName.toLatin1().constData(), filter.contains("Compressed"));
+}
+
 void MainWindow::on_actionSaveScreenshot_triggered() {
     // Open a file dialog to save the PNG image
     QString fileName = QFileDialog::getSaveFileName(this,
@@ -209,6 +295,110 @@ void MainWindow::on_actionSaveScreenshot_triggered() {
     pipeline->SaveScreenshot(fileName.toLatin1().constData());
 }
 
+void MainWindow::on_actionSaveLargeScreenshot_triggered() {
+    // Ask for the magnification first, so the image size can be shown
+    bool ok;
+    int magnification = QInputDialog::getInteger(this,
+                                                 "Save Large Screenshot",
+                                                 QString("Magnification (window is %1 x %2):").arg(qvtkWidget->width()).arg(qvtkWidget->height()),
+                                                 4, 1, 32, 1, &ok);
+
+    if (!ok) {
+        return;
+    }
+
+    // Open a file dialog to save the PNG image
+    QString fileName = QFileDialog::getSaveFileName(this,
+                                                    "Save Large Screenshot",
+                                                    "",
+                                                    "PNG Files (*.png)");
+
+    // Check for file name
+    if (fileName == "") {
+        return;
+    }
+
+    // Render in tiles and save
+    pipeline->SaveLargeScreenshot(fileName.toLatin1().constData(), magnification);
+}
+
+void MainWindow::on_actionAddMovieKeyframe_triggered() {
+    // Open a file dialog for the movie path, which is appended to
+    QString fileName = QFileDialog::getSaveFileName(this,
+                                                    "Add Movie Keyframe",
+                                                    "",
+                                                    "Text Files (*.txt)",
+                                                    NULL,
+                                                    QFileDialog::DontConfirmOverwrite);
+
+    // Check for file name
+    if (fileName == "") {
+        return;
+    }
+
+    bool ok;
+    double time = QInputDialog::getDouble(this,
+                                          "Add Movie Keyframe",
+                                          "Time (s):",
+                                          0.0, 0.0, 100000.0, 2, &ok);
+
+    if (!ok) {
+        return;
+    }
+
+    // Add the current camera view and clip settings
+    pipeline->AddMovieKeyframe(fileName.toLatin1().constData(), time);
+}
+
+void MainWindow::on_actionSaveMovie_triggered() {
+    // Open a file dialog to read the movie path
+    QString pathFileName = QFileDialog::getOpenFileName(this,
+                                                        "Open Movie Path",
+                                                        "",
+                                                        "Text Files (*.txt)");
+
+    // Check for file name
+    if (pathFileName == "") {
+        return;
+    }
+
+    // Open a file dialog for the frames, which are numbered after the name
+    QString fileName = QFileDialog::getSaveFileName(this,
+                                                    "Save Movie Frames",
+                                                    "",
+                                                    "PNG Files (*.png)");
+
+    // Check for file name
+    if (fileName == "") {
+        return;
+    }
+
+    if (fileName.endsWith(".png", Qt::CaseInsensitive)) {
+        fileName.chop(4);
+    }
+
+    bool ok;
+    double frameRate = QInputDialog::getDouble(this,
+                                               "Save Movie",
+                                               "Frames per second:",
+                                               30.0, 1.0, 240.0, 2, &ok);
+
+    if (!ok) {
+        return;
+    }
+
+    bool clip = QMessageBox::question(this,
+                                      "Save Movie",
+                                      "Interpolate clip settings from the keyframes?",
+                                      QMessageBox::Yes | QMessageBox::No,
+                                      QMessageBox::No) == QMessageBox::Yes;
+
+    // Render the frames
+    pipeline->SaveMovie(pathFileName.toLatin1().constData(), fileName.toLatin1().constData(), frameRate, clip);
+
+    RefreshGUI();
+}
+
 void MainWindow::on_actionSaveCameraView_triggered() {
     // Open a file dialog to save the text file
     QString fileName = QFileDialog::getSaveFileName(this,
@@ -275,6 +465,52 @@ void MainWindow::on_actionOpenClipSettings_triggered() {
     RefreshGUI();
 }
 
+void MainWindow::on_actionSaveBatchStatistics_triggered() {
+    // Open a file dialog to read the clipping boxes
+    QString boxFileName = QFileDialog::getOpenFileName(this,
+                                                       "Open Clipping Boxes",
+                                                       "",
+                                                       "Text Files (*.txt)");
+
+    // Check for file name
+    if (boxFileName == "") {
+        return;
+    }
+
+    // Open a file dialog to save the statistics table
+    QString fileName = QFileDialog::getSaveFileName(this,
+                                                    "Save Batch Statistics",
+                                                    "",
+                                                    "Text Files (*.txt)");
+
+    // Check for file name
+    if (fileName == "") {
+        return;
+    }
+
+    // Compute and save statistics for all boxes
+    pipeline->SaveBatchStatistics(boxFileName.toLatin1().constData(), fileName.toLatin1().constData());
+}
+
+void MainWindow::on_actionSaveProfile_triggered() {
+    // Open a file dialog to save the profile table
+    QString fileName = QFileDialog::getSaveFileName(this,
+                                                    "Save Profile",
+                                                    "",
+                                                    "Text Files (*.txt)");
+
+    // Check for file name
+    if (fileName == "") {
+        return;
+    }
+
+    // Save the profile of the current clip
+    pipeline->ComputeProfile(profileBinWidthSpinBox->value());
+    pipeline->SaveProfile(fileName.toLatin1().constData());
+
+    RefreshProfile();
+}
+
 void MainWindow::on_actionExit_triggered() {
     qApp->exit();
 }
@@ -283,7 +519,7 @@ void MainWindow::on_actionExit_triggered() {
 void MainWindow::on_showDataCheckBox_toggled(bool checked) {
     pipeline->SetShowData(checked);
 
-    pipeline->Render();
+    ScheduleRender();
 }
 
 void MainWindow::on_dataOpacitySlider_sliderMoved(int value) {
@@ -296,7 +532,7 @@ void MainWindow::on_dataOpacitySlider_valueChanged(int value) {
     // Update the pipeline
     pipeline->SetDataOpacity((double)value / 100.0);
 
-    pipeline->Render();
+    ScheduleRender();
 }
 
 void MainWindow::on_dataOpacityLineEdit_editingFinished() {
@@ -306,7 +542,7 @@ void MainWindow::on_dataOpacityLineEdit_editingFinished() {
 void MainWindow::on_showBuildingGeometryCheckBox_toggled(bool checked) {
     pipeline->SetShowBuilding(checked);
 
-    pipeline->Render();
+    ScheduleRender();
 }
 
 
@@ -316,7 +552,7 @@ void MainWindow::on_roofOffsetRadioButton_toggled(bool checked) {
     // Need to update GUI
     RefreshGUI();
 
-    pipeline->Render();
+    ScheduleRender();
 }
 
 void MainWindow::on_meshRadioButton_toggled(bool checked) {
@@ -325,7 +561,7 @@ void MainWindow::on_meshRadioButton_toggled(bool checked) {
     // Need to update GUI
     RefreshGUI();
 
-    pipeline->Render();
+    ScheduleRender();
 }
 
 
@@ -334,20 +570,23 @@ void MainWindow::on_xyMagnitudeRadioButton_toggled(bool checked) {
 
     // Need to update color map range
     RefreshColorMap();
+    RefreshProfile();
 
-    pipeline->Render();
+    ScheduleRender();
 }
 
 void MainWindow::on_xyAngleRadioButton_toggled(bool checked) {
     minColorMapSpinBox->setEnabled(!checked);
     maxColorMapSpinBox->setEnabled(!checked);
+    colorMapRangeComboBox->setEnabled(!checked);
 
     pipeline->SetVectorData(VTKPipeline::XYAngle);
 
     // Need to update color map range
     RefreshColorMap();
+    RefreshProfile();
 
-    pipeline->Render();
+    ScheduleRender();
 }
 
 void MainWindow::on_zComponentRadioButton_toggled(bool checked) {
@@ -355,8 +594,9 @@ void MainWindow::on_zComponentRadioButton_toggled(bool checked) {
 
     // Need to update color map range
     RefreshColorMap();
+    RefreshProfile();
 
-    pipeline->Render();
+    ScheduleRender();
 }
 
 
@@ -370,7 +610,7 @@ void MainWindow::on_extractRadioButton_toggled(bool checked) {
     clipSizeZSlider->setEnabled(true);
     clipSizeZLineEdit->setEnabled(true);
 
-    pipeline->Render();
+    ScheduleRender();
 }
 
 void MainWindow::on_fastClipRadioButton_toggled(bool checked) {
@@ -383,7 +623,7 @@ void MainWindow::on_fastClipRadioButton_toggled(bool checked) {
     clipSizeZSlider->setEnabled(true);
     clipSizeZLineEdit->setEnabled(true);
 
-    pipeline->Render();
+    ScheduleRender();
 }
 
 void MainWindow::on_accurateClipRadioButton_toggled(bool checked) {
@@ -396,7 +636,7 @@ void MainWindow::on_accurateClipRadioButton_toggled(bool checked) {
     clipSizeZSlider->setEnabled(true);
     clipSizeZLineEdit->setEnabled(true);
 
-    pipeline->Render();
+    ScheduleRender();
 }
 
 void MainWindow::on_cutXRadioButton_toggled(bool checked) {
@@ -409,7 +649,7 @@ void MainWindow::on_cutXRadioButton_toggled(bool checked) {
     clipSizeZSlider->setEnabled(true);
     clipSizeZLineEdit->setEnabled(true);
 
-    pipeline->Render();
+    ScheduleRender();
 }
 
 void MainWindow::on_cutYRadioButton_toggled(bool checked) {
@@ -422,7 +662,7 @@ void MainWindow::on_cutYRadioButton_toggled(bool checked) {
     clipSizeZSlider->setEnabled(true);
     clipSizeZLineEdit->setEnabled(true);
 
-    pipeline->Render();
+    ScheduleRender();
 }
 
 void MainWindow::on_cutZRadioButton_toggled(bool checked) {
@@ -435,7 +675,7 @@ void MainWindow::on_cutZRadioButton_toggled(bool checked) {
     clipSizeZSlider->setEnabled(false);
     clipSizeZLineEdit->setEnabled(false);
 
-    pipeline->Render();
+    ScheduleRender();
 }
 
 
@@ -447,7 +687,7 @@ void MainWindow::on_clipCenterXSlider_valueChanged(int value) {
                                    clipCenterYSlider->value(),
                                    clipCenterZSlider->value());
 
-    pipeline->Render();
+    ScheduleRender();
 }
 
 void MainWindow::on_clipCenterXLineEdit_editingFinished() {
@@ -463,7 +703,7 @@ void MainWindow::on_clipCenterYSlider_valueChanged(int value) {
                                    clipCenterYSlider->value(),
                                    clipCenterZSlider->value());
 
-    pipeline->Render();
+    ScheduleRender();
 }
 
 void MainWindow::on_clipCenterYLineEdit_editingFinished() {
@@ -479,7 +719,7 @@ void MainWindow::on_clipCenterZSlider_valueChanged(int value) {
                                    clipCenterYSlider->value(),
                                    clipCenterZSlider->value());
 
-    pipeline->Render();
+    ScheduleRender();
 }
 
 void MainWindow::on_clipCenterZLineEdit_editingFinished() {
@@ -495,7 +735,7 @@ void MainWindow::on_clipSizeXSlider_valueChanged(int value) {
                                  clipSizeYSlider->value(),
                                  clipSizeZSlider->value());
 
-    pipeline->Render();
+    ScheduleRender();
 }
 
 void MainWindow::on_clipSizeXLineEdit_editingFinished() {
@@ -511,7 +751,7 @@ void MainWindow::on_clipSizeYSlider_valueChanged(int value) {
                                  clipSizeYSlider->value(),
                                  clipSizeZSlider->value());
 
-    pipeline->Render();
+    ScheduleRender();
 }
 
 void MainWindow::on_clipSizeYLineEdit_editingFinished() {
@@ -527,7 +767,7 @@ void MainWindow::on_clipSizeZSlider_valueChanged(int value) {
                                  clipSizeYSlider->value(),
                                  clipSizeZSlider->value());
 
-    pipeline->Render();
+    ScheduleRender();
 }
 
 void MainWindow::on_clipSizeZLineEdit_editingFinished() {
@@ -539,14 +779,17 @@ void MainWindow::on_clipRotationSpinBox_editingFinished() {
     // Update the pipeline
     pipeline->SetClippingBoxRotation(clipRotationSpinBox->value());
 
-    pipeline->Render();
+    ScheduleRender();
 }
 
 
 void MainWindow::on_applyClipButton_clicked() {
     pipeline->UpdateClipping();
 
-    pipeline->Render();
+    // Clears the profile of the previous clip
+    RefreshProfile();
+
+    ScheduleRender();
 }
 
 
@@ -554,7 +797,7 @@ void MainWindow::on_applyClipButton_clicked() {
 void MainWindow::on_resetClipButton_clicked() {
     pipeline->ResetClippingBox();
 
-    pipeline->Render();
+    ScheduleRender();
 
     RefreshGUI();
 }
@@ -562,12 +805,17 @@ void MainWindow::on_resetClipButton_clicked() {
 void MainWindow::on_showClipCheckBox_toggled(bool checked) {
     pipeline->SetShowClippingBox(checked);
 
-    pipeline->Render();
+    ScheduleRender();
 }
 
 
 void MainWindow::on_roofOffsetThicknessSlider_sliderMoved(int value) {
     roofOffsetThicknessLineEdit->setText(QString().sprintf("%d", value));
+
+    // Only moves points, so cheap enough to show while dragging
+    pipeline->SetRoofOffsetThickness(value);
+
+    ScheduleRender();
 }
 
 void MainWindow::on_roofOffsetThicknessSlider_valueChanged(int value) {
@@ -575,7 +823,7 @@ void MainWindow::on_roofOffsetThicknessSlider_valueChanged(int value) {
 
     pipeline->SetRoofOffsetThickness(value);
 
-    pipeline->Render();
+    ScheduleRender();
 }
 
 void MainWindow::on_roofOffsetThicknessLineEdit_editingFinished() {
@@ -591,7 +839,10 @@ void MainWindow::on_minColorMapSpinBox_editingFinished() {
     // Update the color map
     pipeline->SetColorMapRange(minColorMapSpinBox->value(), maxColorMapSpinBox->value());
 
-    pipeline->Render();
+    // The kind of color map can change with the range
+    RefreshColorMapList();
+
+    ScheduleRender();
 }
 
 void MainWindow::on_maxColorMapSpinBox_editingFinished() {
@@ -601,38 +852,57 @@ void MainWindow::on_maxColorMapSpinBox_editingFinished() {
     // Update the color map
     pipeline->SetColorMapRange(minColorMapSpinBox->value(), maxColorMapSpinBox->value());
 
-    pipeline->Render();
+    // The kind of color map can change with the range
+    RefreshColorMapList();
+
+    ScheduleRender();
+}
+
+void MainWindow::on_colorMapComboBox_activated(int index) {
+    pipeline->SetColorMap(colorMapComboBox->itemData(index).toInt());
+
+    ScheduleRender();
+}
+
+void MainWindow::on_colorMapRangeComboBox_activated(int index) {
+    // Items are in the same order as the modes
+    pipeline->SetColorMapRangeMode((VTKPipeline::ColorMapRangeMode)index);
+
+    // Need to update color map range
+    RefreshColorMap();
+
+    ScheduleRender();
 }
 
 
 void MainWindow::on_volumeAreaStatisticsLabelCheckBox_toggled(bool checked) {
     pipeline->SetShowVolumeAreaStatisticsLabel(checked);
     
-    pipeline->Render();
+    ScheduleRender();
 }
 
 void MainWindow::on_clippingBoxLabelCheckBox_toggled(bool checked) {
     pipeline->SetShowClippingBoxLabel(checked);
     
-    pipeline->Render();
+    ScheduleRender();
 }
 
 void MainWindow::on_cameraLabelCheckBox_toggled(bool checked) {
     pipeline->SetShowCameraLabel(checked);
     
-    pipeline->Render();
+    ScheduleRender();
 }
 
 void MainWindow::on_dataStatisticsLabelCheckBox_toggled(bool checked) {
     pipeline->SetShowDataStatisticsLabel(checked);
     
-    pipeline->Render();
+    ScheduleRender();
 }
 
 void MainWindow::on_fileNameLabelCheckBox_toggled(bool checked) {
     pipeline->SetShowFileNameLabel(checked);
     
-    pipeline->Render();
+    ScheduleRender();
 }
 
 
@@ -641,6 +911,8 @@ void MainWindow::on_cameraPositionXSpinBox_editingFinished() {
                                 cameraPositionYSpinBox->value(),
                                 cameraPositionZSpinBox->value(),
                                 cameraDistanceSpinBox->value());
+
+    ScheduleRender();
 }
 
 void MainWindow::on_cameraPositionYSpinBox_editingFinished() {
@@ -648,6 +920,8 @@ void MainWindow::on_cameraPositionYSpinBox_editingFinished() {
                                 cameraPositionYSpinBox->value(),
                                 cameraPositionZSpinBox->value(),
                                 cameraDistanceSpinBox->value());
+
+    ScheduleRender();
 }
 
 void MainWindow::on_cameraPositionZSpinBox_editingFinished() {
@@ -655,6 +929,8 @@ void MainWindow::on_cameraPositionZSpinBox_editingFinished() {
                                 cameraPositionYSpinBox->value(),
                                 cameraPositionZSpinBox->value(),
                                 cameraDistanceSpinBox->value());
+
+    ScheduleRender();
 }
 
 void MainWindow::on_cameraDistanceSpinBox_editingFinished() {
@@ -662,6 +938,8 @@ void MainWindow::on_cameraDistanceSpinBox_editingFinished() {
                                 cameraPositionYSpinBox->value(),
                                 cameraPositionZSpinBox->value(),
                                 cameraDistanceSpinBox->value());
+
+    ScheduleRender();
 }
 
 
@@ -670,6 +948,8 @@ void MainWindow::on_cameraRotationWSpinBox_editingFinished() {
                                 cameraRotationXSpinBox->value(),
                                 cameraRotationYSpinBox->value(),
                                 cameraRotationZSpinBox->value());
+
+    ScheduleRender();
 }
 
 void MainWindow::on_cameraRotationXSpinBox_editingFinished() {
@@ -677,6 +957,8 @@ void MainWindow::on_cameraRotationXSpinBox_editingFinished() {
                                 cameraRotationXSpinBox->value(),
                                 cameraRotationYSpinBox->value(),
                                 cameraRotationZSpinBox->value());
+
+    ScheduleRender();
 }
 
 void MainWindow::on_cameraRotationYSpinBox_editingFinished() {
@@ -684,6 +966,8 @@ void MainWindow::on_cameraRotationYSpinBox_editingFinished() {
                                 cameraRotationXSpinBox->value(),
                                 cameraRotationYSpinBox->value(),
                                 cameraRotationZSpinBox->value());
+
+    ScheduleRender();
 }
 
 void MainWindow::on_cameraRotationZSpinBox_editingFinished() {
@@ -691,19 +975,80 @@ void MainWindow::on_cameraRotationZSpinBox_editingFinished() {
                                 cameraRotationXSpinBox->value(),
                                 cameraRotationYSpinBox->value(),
                                 cameraRotationZSpinBox->value());
+
+    ScheduleRender();
 }
 
 
 void MainWindow::on_resetCameraXButton_clicked() {
     pipeline->ResetCameraX();
+
+    ScheduleRender();
 }
 
 void MainWindow::on_resetCameraYButton_clicked() {
     pipeline->ResetCameraY();
+
+    ScheduleRender();
 }
 
 void MainWindow::on_resetCameraZButton_clicked() {
     pipeline->ResetCameraZ();
+
+    ScheduleRender();
+}
+
+
+void MainWindow::on_computeProfileButton_clicked() {
+    pipeline->ComputeProfile(profileBinWidthSpinBox->value());
+
+    RefreshProfile();
+}
+
+
+void MainWindow::RefreshStatistics() {
+    if (pipeline->UpdateStatistics()) {
+        ScheduleRender();
+    }
+
+    // Also shows the camera update cost while rotating, which doesn't go through ScheduleRender()
+    RefreshStatusBar();
+}
+
+void MainWindow::PollBackground() {
+    pipeline->UpdateBackground();
+}
+
+
+void MainWindow::ScheduleRender() {
+    // A render is already coming, which will include this change
+    if (renderTimer->isActive()) return;
+
+    // Leave at least one display frame between renders, so widget events
+    // queued during a slow render are all handled before the next one
+    int wait = minimumFrameInterval - renderClock.elapsed();
+    renderTimer->start(wait > 0 ? wait : 0);
+}
+
+void MainWindow::RenderScheduled() {
+    QTime clock;
+    clock.start();
+
+    pipeline->Render();
+
+    // Smoothed frame time
+    int elapsed = clock.elapsed();
+    frameTime = frameTime > 0.0 ? frameTime * 0.8 + elapsed * 0.2 : elapsed;
+
+    RefreshStatusBar();
+
+    renderClock.start();
+}
+
+void MainWindow::RefreshStatusBar() {
+    statusbar->showMessage(QString("Frame time: %1 ms, camera update: %2 ms")
+                           .arg(frameTime, 0, 'f', 1)
+                           .arg(pipeline->GetCameraUpdateCost() * 1000.0, 0, 'f', 3));
 }
 
 
@@ -762,6 +1107,8 @@ void MainWindow::RefreshGUI() {
 
     minColorMapSpinBox->setEnabled(hasData && pipeline->GetVectorData() != VTKPipeline::XYAngle);
     maxColorMapSpinBox->setEnabled(hasData && pipeline->GetVectorData() != VTKPipeline::XYAngle);
+    colorMapComboBox->setEnabled(hasData);
+    colorMapRangeComboBox->setEnabled(hasData && pipeline->GetVectorData() != VTKPipeline::XYAngle);
 
     volumeAreaStatisticsLabelCheckBox->setEnabled(hasData);
     clippingBoxLabelCheckBox->setEnabled(hasData);
@@ -769,6 +1116,9 @@ void MainWindow::RefreshGUI() {
     dataStatisticsLabelCheckBox->setEnabled(hasData);
     fileNameLabelCheckBox->setEnabled(hasData);
 
+    profileBinWidthSpinBox->setEnabled(hasData);
+    computeProfileButton->setEnabled(hasData);
+
     cameraPositionXSpinBox->setEnabled(hasData || hasBuilding);
     cameraPositionYSpinBox->setEnabled(hasData || hasBuilding);
     cameraPositionZSpinBox->setEnabled(hasData || hasBuilding);
@@ -1001,6 +1351,9 @@ void MainWindow::RefreshGUI() {
 
         // Refresh the color map
         RefreshColorMap();
+
+        // The clip may have changed
+        RefreshProfile();
     }
 }
 
@@ -1053,20 +1406,58 @@ void MainWindow::RefreshBuilding() {
 
 void MainWindow::RefreshColorMap() {
     double range[2];
+    double colorMapRange[2];
 
     if (pipeline->GetVectorData() == VTKPipeline::XYAngle) {
-        range[0] = 0.0;
-        range[1] = 360.0;
+        range[0] = colorMapRange[0] = 0.0;
+        range[1] = colorMapRange[1] = 360.0;
     }
     else {
+        // The automatic range can be within the data range
         pipeline->GetDataRange(range);
+        pipeline->GetColorMapRange(colorMapRange);
     }
 
     minColorMapSpinBox->setRange(range[0], range[1]);
-    minColorMapSpinBox->setValue(range[0]);
+    minColorMapSpinBox->setValue(colorMapRange[0]);
 
     maxColorMapSpinBox->setRange(range[0], range[1]);
-    maxColorMapSpinBox->setValue(range[1]);
+    maxColorMapSpinBox->setValue(colorMapRange[1]);
+
+    RefreshColorMapList();
+}
+
+void MainWindow::RefreshColorMapList() {
+    // List the color maps for the current kind of data
+    ColorMap::Kind kind = pipeline->GetColorMapKind();
+
+    colorMapComboBox->blockSignals(true);
+    colorMapComboBox->clear();
+
+    for (int i = 0; i < ColorMap::GetNumberOfColorMaps(); i++) {
+        if (ColorMap::GetKind(i) != kind) continue;
+
+        colorMapComboBox->addItem(ColorMap::GetName(i), i);
+
+        if (i == pipeline->GetColorMap()) {
+            colorMapComboBox->setCurrentIndex(colorMapComboBox->count() - 1);
+        }
+    }
+
+    colorMapComboBox->blockSignals(false);
+}
+
+void MainWindow::RefreshProfile() {
+    // Plot the profile for the current vector data
+    if (pipeline->GetVectorData() == VTKPipeline::XYAngle) {
+        profilePlot->SetProfile(pipeline->GetProfile(), XYAngleValue, "XY Velocity Angle (degrees)");
+    }
+    else if (pipeline->GetVectorData() == VTKPipeline::ZComponent) {
+        profilePlot->SetProfile(pipeline->GetProfile(), ZComponentValue, "Z Velocity Component (m/s)");
+    }
+    else {
+        profilePlot->SetProfile(pipeline->GetProfile(), XYMagnitudeValue, "XY Velocity Magnitude (m/s)");
+    }
 }
 
 
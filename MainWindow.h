@@ -22,15 +22,19 @@
 #define MAINWINDOW_H
 
 
+#include <qdatetime.h>
 #include <qmainwindow.h>
 
 #include "ui_MainWindow.h"
 
+#include "PipelineObserver.h"
 
+
+class QTimer;
 class VTKPipeline;
 
 
-class MainWindow : public QMainWindow, private Ui_MainWindow {
+class MainWindow : public QMainWindow, public PipelineObserver, private Ui_MainWindow {
     Q_OBJECT
 
 public:
@@ -38,7 +42,10 @@ public:
     MainWindow(QWidget* parent = NULL);
     virtual ~MainWindow();
 
-    // Called from VTKPipeline
+    // PipelineObserver, called by VTKPipeline after the camera moves
+    virtual void CameraChanged(const double position[3], double distance, const double orientation[4]);
+
+    // Set the camera widgets without changing the camera
     void SetCameraPosition(double x, double y, double z, double d);
     void SetCameraRotation(double w, double x, double y, double z);
 
@@ -53,11 +60,18 @@ public slots:
     virtual void on_actionOpenMesh_triggered();
     virtual void on_actionOpenBuildingGeometry_triggered();
     virtual void on_actionSaveData_triggered();
+    virtual void on_actionSaveFullData_triggered();
+    virtual void on_actionSaveClip_triggered();
     virtual void on_actionSaveScreenshot_triggered();
+    virtual void on_actionSaveLargeScreenshot_triggered();
+    virtual void on_actionAddMovieKeyframe_triggered();
+    virtual void on_actionSaveMovie_triggered();
     virtual void on_actionSaveCameraView_triggered();
     virtual void on_actionOpenCameraView_triggered();
     virtual void on_actionSaveClipSettings_triggered();
     virtual void on_actionOpenClipSettings_triggered();
+    virtual void on_actionSaveBatchStatistics_triggered();
+    virtual void on_actionSaveProfile_triggered();
     virtual void on_actionExit_triggered();
 
     // Widget events
@@ -111,6 +125,8 @@ public slots:
 
     virtual void on_minColorMapSpinBox_editingFinished();
     virtual void on_maxColorMapSpinBox_editingFinished();
+    virtual void on_colorMapComboBox_activated(int index);
+    virtual void on_colorMapRangeComboBox_activated(int index);
 
     virtual void on_volumeAreaStatisticsLabelCheckBox_toggled(bool checked);
     virtual void on_clippingBoxLabelCheckBox_toggled(bool checked);
@@ -132,6 +148,13 @@ public slots:
     virtual void on_resetCameraYButton_clicked();
     virtual void on_resetCameraZButton_clicked();
 
+    virtual void on_computeProfileButton_clicked();
+
+    // Timer events
+    virtual void RefreshStatistics();
+    virtual void PollBackground();
+    virtual void RenderScheduled();
+
 protected:
     VTKPipeline* pipeline;
 
@@ -145,11 +168,23 @@ protected:
 
 //    QLabel* statusBarLabel;
 
+    // Renders requested by the GUI are combined, at most one per frame
+    QTimer* renderTimer;
+    QTime renderClock;
+    double frameTime;
+
+    void ScheduleRender();
+
+    // Show frame time and camera update cost
+    void RefreshStatusBar();
+
     // Set GUI widget values from the VTK pipeline
     void RefreshGUI();
 
     void RefreshBuilding();
     void RefreshColorMap();
+    void RefreshColorMapList();
+    void RefreshProfile();
 
     void RecomputeBounds(double in[6], int out[6]);
 };
@@ -0,0 +1,253 @@
+/*=========================================================================
+
+  Name:        PNGWriter.cpp
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+  Description: Writes an RGB PNG file a band of rows at a time, so the
+               whole image never needs to be in memory.  The rows of each
+               band are compressed in parallel.
+
+=========================================================================*/
+
+
+#include "PNGWriter.h"
+
+#include <vtk_zlib.h>
+
+#include <iostream>
+
+#include <string.h>
+
+
+// Big-endian 32-bit value, as used throughout PNG
+static void PutInt(unsigned char* p, unsigned long v) {
+    p[0] = (unsigned char)(v >> 24);
+    p[1] = (unsigned char)(v >> 16);
+    p[2] = (unsigned char)(v >> 8);
+    p[3] = (unsigned char)v;
+}
+
+
+PNGWriter::PNGWriter() {
+    width = 0;
+    height = 0;
+    rowsWritten = 0;
+    adler = 1;
+    error = false;
+    input = NULL;
+    inputRows = 0;
+}
+
+PNGWriter::~PNGWriter() {
+    if (file.is_open()) file.close();
+}
+
+
+bool PNGWriter::Open(const char* fileName, int imageWidth, int imageHeight) {
+    if (imageWidth <= 0 || imageHeight <= 0) {
+        std::cout << "Invalid image size " << imageWidth << " x " << imageHeight << std::endl;
+        return false;
+    }
+
+    file.open(fileName, std::ios::out | std::ios::binary);
+
+    if (!file.good()) {
+        std::cout << "Could not open " << fileName << " for writing" << std::endl;
+        return false;
+    }
+
+    name = fileName;
+    width = imageWidth;
+    height = imageHeight;
+    rowsWritten = 0;
+    adler = adler32(0L, Z_NULL, 0);
+    error = false;
+
+    const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A };
+    file.write((const char*)signature, 8);
+
+    // 8-bit RGB, no interlacing
+    unsigned char ihdr[13];
+    PutInt(ihdr, width);
+    PutInt(ihdr + 4, height);
+    ihdr[8] = 8;
+    ihdr[9] = 2;
+    ihdr[10] = 0;
+    ihdr[11] = 0;
+    ihdr[12] = 0;
+    WriteChunk("IHDR", ihdr, 13);
+
+    // Deflate with a 32K window, fastest level
+    header.resize(2);
+    header[0] = 0x78;
+    header[1] = 0x01;
+
+    return file.good();
+}
+
+
+bool PNGWriter::WriteRows(const unsigned char* rgb, int numRows) {
+    if (!file.is_open() || error) return false;
+
+    if (rowsWritten + numRows > height) {
+        std::cout << "Too many rows for " << name << std::endl;
+        error = true;
+        return false;
+    }
+
+    input = rgb;
+    inputRows = numRows;
+
+    vtkMultiThreader* threader = vtkMultiThreader::New();
+    int numThreads = threader->GetNumberOfThreads();
+    numThreads = numThreads > numRows ? numRows : numThreads;
+    numThreads = numThreads < 1 ? 1 : numThreads;
+
+    strips.resize(numThreads);
+
+    threader->SetNumberOfThreads(numThreads);
+    threader->SetSingleMethod(ThreadFunction, this);
+    threader->SingleMethodExecute();
+    threader->Delete();
+
+    // Write the strips in order
+    for (int i = 0; i < numThreads; i++) {
+        Strip& strip = strips[i];
+
+        if (!strip.ok) {
+            std::cout << "Error compressing " << name << std::endl;
+            error = true;
+            break;
+        }
+
+        if (strip.length == 0) continue;
+
+        if (!header.empty()) {
+            strip.data.insert(strip.data.begin(), header.begin(), header.end());
+            header.clear();
+        }
+
+        WriteChunk("IDAT", &strip.data[0], strip.data.size());
+
+        adler = adler32_combine(adler, strip.adler, strip.length);
+    }
+
+    strips.clear();
+    input = NULL;
+
+    rowsWritten += numRows;
+
+    return !error && file.good();
+}
+
+
+bool PNGWriter::Close() {
+    if (!file.is_open()) return false;
+
+    if (!error && rowsWritten != height) {
+        std::cout << "Only " << rowsWritten << " of " << height << " rows written to " << name << std::endl;
+        error = true;
+    }
+
+    if (!error) {
+        // Empty final block, then the Adler-32 of all of the filtered rows
+        unsigned char end[6] = { 0x03, 0x00 };
+        PutInt(end + 2, adler);
+
+        WriteChunk("IDAT", end, 6);
+        WriteChunk("IEND", NULL, 0);
+    }
+
+    bool success = !error && file.good();
+
+    file.close();
+
+    return success;
+}
+
+
+void PNGWriter::WriteChunk(const char* type, const unsigned char* data, unsigned long length) {
+    unsigned char buffer[4];
+
+    PutInt(buffer, length);
+    file.write((const char*)buffer, 4);
+    file.write(type, 4);
+    if (length > 0) file.write((const char*)data, length);
+
+    unsigned long crc = crc32(0L, Z_NULL, 0);
+    crc = crc32(crc, (const Bytef*)type, 4);
+    if (length > 0) crc = crc32(crc, data, length);
+
+    PutInt(buffer, crc);
+    file.write((const char*)buffer, 4);
+}
+
+
+VTK_THREAD_RETURN_TYPE PNGWriter::ThreadFunction(void* arg) {
+    vtkMultiThreader::ThreadInfo* info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+    PNGWriter* self = static_cast<PNGWriter*>(info->UserData);
+
+    self->ThreadExecute(info->ThreadID, info->NumberOfThreads);
+
+    return VTK_THREAD_RETURN_VALUE;
+}
+
+void PNGWriter::ThreadExecute(int thread, int numThreads) {
+    Strip& strip = strips[thread];
+    strip.length = 0;
+    strip.adler = adler32(0L, Z_NULL, 0);
+    strip.ok = true;
+
+    int start = inputRows * thread / numThreads;
+    int end = inputRows * (thread + 1) / numThreads;
+    if (start >= end) return;
+
+    // Sub filter: each byte minus the same channel of the previous pixel
+    int rowSize = width * 3;
+    std::vector<unsigned char> filtered((size_t)(end - start) * (rowSize + 1));
+
+    unsigned char* out = &filtered[0];
+    for (int i = start; i < end; i++) {
+        const unsigned char* row = input + (size_t)i * rowSize;
+
+        *out++ = 1;
+        for (int j = 0; j < 3; j++) *out++ = row[j];
+        for (int j = 3; j < rowSize; j++) *out++ = (unsigned char)(row[j] - row[j - 3]);
+    }
+
+    strip.length = filtered.size();
+    strip.adler = adler32(strip.adler, &filtered[0], filtered.size());
+
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+
+    // Negative window bits for raw deflate without a zlib header
+    if (deflateInit2(&stream, Z_BEST_SPEED, Z_DEFLATED, -15, 8, Z_FILTERED) != Z_OK) {
+        strip.ok = false;
+        return;
+    }
+
+    // A sync flush ends the strip on a byte boundary without ending the stream
+    strip.data.resize(deflateBound(&stream, filtered.size()) + 16);
+
+    stream.next_in = &filtered[0];
+    stream.avail_in = filtered.size();
+    stream.next_out = &strip.data[0];
+    stream.avail_out = strip.data.size();
+
+    int result = deflate(&stream, Z_SYNC_FLUSH);
+
+    strip.ok = result == Z_OK && stream.avail_in == 0;
+    strip.data.resize(stream.total_out);
+
+    deflateEnd(&stream);
+}
@@ -0,0 +1,80 @@
+/*=========================================================================
+
+  Name:        PNGWriter.h
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+  Description: Writes an RGB PNG file a band of rows at a time, so the
+               whole image never needs to be in memory.  The rows of each
+               band are compressed in parallel.
+
+=========================================================================*/
+
+
+#ifndef PNGWRITER_H
+#define PNGWRITER_H
+
+
+#include <vtkMultiThreader.h>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+
+class PNGWriter {
+public:
+    PNGWriter();
+    ~PNGWriter();
+
+    // Write the file header for an image of the given size
+    bool Open(const char* fileName, int imageWidth, int imageHeight);
+
+    // Append RGB rows, top row first
+    bool WriteRows(const unsigned char* rgb, int numRows);
+
+    // Finish the file.  Fails if not all rows were written.
+    bool Close();
+
+protected:
+    std::ofstream file;
+    std::string name;
+
+    int width;
+    int height;
+    int rowsWritten;
+
+    // zlib header, written with the first data
+    std::vector<unsigned char> header;
+    unsigned long adler;
+    bool error;
+
+    // Each thread deflates a strip of rows, flushed to a byte boundary so
+    // the strips can be concatenated into one zlib stream
+    struct Strip {
+        std::vector<unsigned char> data;
+        unsigned long adler;
+        unsigned long length;
+        bool ok;
+    };
+    std::vector<Strip> strips;
+
+    const unsigned char* input;
+    int inputRows;
+
+    void WriteChunk(const char* type, const unsigned char* data, unsigned long length);
+
+    static VTK_THREAD_RETURN_TYPE ThreadFunction(void* arg);
+    void ThreadExecute(int thread, int numThreads);
+};
+
+
+#endif
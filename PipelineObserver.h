@@ -0,0 +1,35 @@
+/*=========================================================================
+
+  Name:        PipelineObserver.h
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+  Description: Interface for receiving updates from VTKPipeline, so the 
+               pipeline doesn't depend on the GUI.
+
+=========================================================================*/
+
+
+#ifndef PIPELINEOBSERVER_H
+#define PIPELINEOBSERVER_H
+
+
+class PipelineObserver {
+public:
+    virtual ~PipelineObserver() {}
+
+    // Called after the camera moves, at a limited rate while interacting.
+    // The orientation is an angle in degrees and an axis.
+    virtual void CameraChanged(const double position[3], double distance, const double orientation[4]) = 0;
+};
+
+
+#endif
@@ -0,0 +1,132 @@
+/*=========================================================================
+
+  Name:        ProfilePlot.cpp
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+  Description: Plots a vertical profile, with height on the vertical
+               axis, the mean as a line and the min/max as a band.
+
+=========================================================================*/
+
+
+#include "ProfilePlot.h"
+
+#include "VerticalProfile.h"
+
+#include <qpainter.h>
+#include <qpolygon.h>
+
+
+ProfilePlot::ProfilePlot(QWidget* parent) : QWidget(parent) {
+    profile = NULL;
+    value = XYMagnitudeValue;
+}
+
+
+void ProfilePlot::SetProfile(VerticalProfile* verticalProfile, int whichValue, const QString& valueLabel) {
+    profile = verticalProfile;
+    value = whichValue;
+    label = valueLabel;
+
+    update();
+}
+
+
+void ProfilePlot::paintEvent(QPaintEvent* event) {
+    QPainter painter(this);
+    painter.fillRect(rect(), Qt::white);
+
+    int numBins = profile ? profile->GetNumberOfBins() : 0;
+
+    // Value range, skipping empty bands
+    double vMin = VTK_DOUBLE_MAX;
+    double vMax = -VTK_DOUBLE_MAX;
+    for (int i = 0; i < numBins; i++) {
+        RegionStatistics& s = profile->GetStatistics(i);
+        if (s.GetNumberOfCells() == 0) continue;
+
+        vMin = s.GetMin(value) < vMin ? s.GetMin(value) : vMin;
+        vMax = s.GetMax(value) > vMax ? s.GetMax(value) : vMax;
+    }
+
+    if (vMin > vMax) {
+        painter.drawText(rect(), Qt::AlignCenter, "No profile");
+        return;
+    }
+
+    if (value == XYAngleValue) {
+        vMin = 0.0;
+        vMax = 360.0;
+    }
+    if (vMax <= vMin) vMax = vMin + 1.0;
+
+    double hMin = profile->GetBinBottom(0);
+    double hMax = profile->GetBinTop(numBins - 1);
+
+    // Plot area, leaving room for labels
+    QRectF area(60.0, 25.0, width() - 70.0, height() - 65.0);
+    if (area.width() <= 0.0 || area.height() <= 0.0) return;
+
+    #define X(v) (area.left() + ((v) - vMin) / (vMax - vMin) * area.width())
+    #define Y(h) (area.bottom() - ((h) - hMin) / (hMax - hMin) * area.height())
+
+    // Min/max for each band
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(QColor(200, 200, 200));
+    for (int i = 0; i < numBins; i++) {
+        RegionStatistics& s = profile->GetStatistics(i);
+        if (s.GetNumberOfCells() == 0) continue;
+
+        painter.drawRect(QRectF(QPointF(X(s.GetMin(value)), Y(profile->GetBinTop(i))),
+                                QPointF(X(s.GetMax(value)), Y(profile->GetBinBottom(i)))));
+    }
+
+    // Mean through the band centers, with gaps at empty bands
+    painter.setPen(QPen(Qt::black, 2.0));
+    painter.setBrush(Qt::NoBrush);
+    QPolygonF line;
+    for (int i = 0; i <= numBins; i++) {
+        if (i == numBins || profile->GetStatistics(i).GetNumberOfCells() == 0) {
+            if (line.size() > 1) painter.drawPolyline(line);
+            else if (line.size() == 1) painter.drawEllipse(line[0], 2.0, 2.0);
+            line.clear();
+            continue;
+        }
+
+        double h = (profile->GetBinBottom(i) + profile->GetBinTop(i)) * 0.5;
+        line.append(QPointF(X(profile->GetStatistics(i).GetMean(value)), Y(h)));
+    }
+
+    #undef X
+    #undef Y
+
+    // Axes and labels
+    painter.setPen(Qt::black);
+    painter.drawRect(area);
+
+    QFontMetrics fm = painter.fontMetrics();
+
+    painter.drawText(QPointF(area.left(), area.bottom() + fm.height()), QString::number(vMin, 'g', 4));
+
+    QString maxLabel = QString::number(vMax, 'g', 4);
+    painter.drawText(QPointF(area.right() - fm.width(maxLabel), area.bottom() + fm.height()), maxLabel);
+
+    painter.drawText(QRectF(area.left(), area.bottom() + fm.height(), area.width(), fm.height() * 1.5),
+                     Qt::AlignCenter, label);
+
+    painter.drawText(QRectF(0.0, area.top() - fm.height() * 0.5, area.left() - 5.0, fm.height()),
+                     Qt::AlignRight, QString::number(hMax, 'g', 5));
+    painter.drawText(QRectF(0.0, area.bottom() - fm.height() * 0.5, area.left() - 5.0, fm.height()),
+                     Qt::AlignRight, QString::number(hMin, 'g', 5));
+
+    painter.drawText(QPointF(area.left(), area.top() - 5.0), "Height (m)");
+}
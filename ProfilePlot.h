@@ -0,0 +1,48 @@
+/*=========================================================================
+
+  Name:        ProfilePlot.h
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+  Description: Plots a vertical profile, with height on the vertical
+               axis, the mean as a line and the min/max as a band.
+
+=========================================================================*/
+
+
+#ifndef PROFILEPLOT_H
+#define PROFILEPLOT_H
+
+
+#include <qwidget.h>
+#include <qstring.h>
+
+
+class VerticalProfile;
+
+
+class ProfilePlot : public QWidget {
+public:
+    ProfilePlot(QWidget* parent = NULL);
+
+    // Set the profile and which value to plot
+    void SetProfile(VerticalProfile* verticalProfile, int whichValue, const QString& valueLabel);
+
+protected:
+    VerticalProfile* profile;
+    int value;
+    QString label;
+
+    virtual void paintEvent(QPaintEvent* event);
+};
+
+
+#endif
@@ -0,0 +1,326 @@
+/*=========================================================================
+
+  Name:        ProgressiveStatistics.cpp
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+  Description: Statistics that are first estimated from a stratified
+               random sample of cells, with confidence intervals, and
+               then computed exactly in a background thread.
+
+=========================================================================*/
+
+
+#include "ProgressiveStatistics.h"
+
+#include "SimplexReader.h"
+
+#include <vtkDataSet.h>
+#include <vtkMath.h>
+#include <vtkMutexLock.h>
+
+#include <vector>
+
+#include <math.h>
+
+
+// The sample is spread over strata of consecutive cells, which are roughly
+// spatially coherent.  Data sets with fewer cells than the sample are
+// computed exactly right away.
+static const int numStrata = 32;
+static const int cellsPerStratum = 128;
+
+// For 95% confidence intervals
+static const double z95 = 1.96;
+
+
+ProgressiveStatistics::ProgressiveStatistics() {
+    size = 0.0;
+    sizeError = 0.0;
+    for (int i = 0; i < NumberOfSimplexValues; i++) {
+        meanError[i] = 0.0;
+    }
+    exact = true;
+
+    threader = vtkMultiThreader::New();
+    threadId = -1;
+    lock = vtkMutexLock::New();
+    input = NULL;
+    backgroundDone = false;
+}
+
+ProgressiveStatistics::~ProgressiveStatistics() {
+    Stop();
+
+    threader->Delete();
+    lock->Delete();
+}
+
+
+void ProgressiveStatistics::Start(vtkDataSet* data) {
+    if (data == NULL || data->GetNumberOfCells() <= numStrata * cellsPerStratum) {
+        Compute(data);
+
+        return;
+    }
+
+    Stop();
+
+    for (int i = 0; i < NumberOfSimplexValues; i++) {
+        meanError[i] = 0.0;
+    }
+    sizeError = 0.0;
+
+    // Quick estimate
+    Estimate(data);
+    exact = false;
+
+    // Work on a deep copy.  A shallow copy would share the point and cell
+    // arrays, which the pipeline can modify or free if it updates while the
+    // thread runs.
+    input = data->NewInstance();
+    input->DeepCopy(data);
+    SimplexReader::Prepare(input);
+
+    background.SetInput(input);
+    background.SetAbort(false);
+    backgroundDone = false;
+
+    threadId = threader->SpawnThread(ThreadFunction, this);
+}
+
+void ProgressiveStatistics::Compute(vtkDataSet* data) {
+    Stop();
+
+    DataSetStatistics exactStatistics;
+    exactStatistics.SetInput(data);
+    exactStatistics.Update();
+    current = exactStatistics.GetStatistics();
+    size = current.GetSize();
+    sizeError = 0.0;
+    for (int i = 0; i < NumberOfSimplexValues; i++) {
+        meanError[i] = 0.0;
+    }
+    exact = true;
+}
+
+void ProgressiveStatistics::Stop() {
+    if (threadId < 0) return;
+
+    background.SetAbort(true);
+    threader->TerminateThread(threadId);
+    threadId = -1;
+
+    input->Delete();
+    input = NULL;
+}
+
+
+bool ProgressiveStatistics::Poll() {
+    if (threadId < 0) return false;
+
+    lock->Lock();
+    bool done = backgroundDone;
+    lock->Unlock();
+
+    if (!done) return false;
+
+    // Thread has finished, so this just cleans up
+    Finish();
+
+    return true;
+}
+
+void ProgressiveStatistics::Finish() {
+    if (threadId < 0) return;
+
+    // Joins the thread without aborting it
+    threader->TerminateThread(threadId);
+    threadId = -1;
+
+    input->Delete();
+    input = NULL;
+
+    current = background.GetStatistics();
+    size = current.GetSize();
+    sizeError = 0.0;
+    for (int i = 0; i < NumberOfSimplexValues; i++) {
+        meanError[i] = 0.0;
+    }
+    exact = true;
+}
+
+
+bool ProgressiveStatistics::IsExact() {
+    return exact;
+}
+
+RegionStatistics& ProgressiveStatistics::GetStatistics() {
+    return current;
+}
+
+
+double ProgressiveStatistics::GetSize() {
+    return size;
+}
+
+double ProgressiveStatistics::GetSizeError() {
+    return sizeError;
+}
+
+double ProgressiveStatistics::GetMeanError(int value) {
+    return meanError[value];
+}
+
+
+void ProgressiveStatistics::Estimate(vtkDataSet* data) {
+    current.Initialize();
+
+    SimplexReader reader(data);
+    std::vector<Simplex> simplices;
+
+    // Area/volume and weighted sum of each value for each sampled cell
+    const int numSamples = numStrata * cellsPerStratum;
+    std::vector<double> w(numSamples);
+    std::vector<double> z[NumberOfSimplexValues];
+    for (int i = 0; i < NumberOfSimplexValues; i++) {
+        z[i].resize(numSamples);
+    }
+
+    double stratumSize[numStrata];
+
+    vtkIdType numCells = data->GetNumberOfCells();
+
+    for (int h = 0; h < numStrata; h++) {
+        vtkIdType start = numCells * h / numStrata;
+        vtkIdType end = numCells * (h + 1) / numStrata;
+        stratumSize[h] = (double)(end - start);
+
+        // Sample with replacement
+        for (int k = 0; k < cellsPerStratum; k++) {
+            vtkIdType cellId = start + (vtkIdType)vtkMath::Random(0.0, stratumSize[h]);
+            cellId = cellId < end ? cellId : end - 1;
+
+            simplices.clear();
+            reader.GetSimplices(cellId, simplices);
+
+            RegionStatistics cell;
+            for (int i = 0; i < (int)simplices.size(); i++) {
+                cell.AddSimplex(simplices[i], BoxClipper::ComputeMeasure(simplices[i]));
+            }
+
+            current.Add(cell);
+
+            int sample = h * cellsPerStratum + k;
+            w[sample] = cell.GetSize();
+            for (int i = 0; i < NumberOfSimplexValues; i++) {
+                z[i][sample] = i == XYAngleValue ? 0.0 : cell.GetMean(i) * cell.GetSize();
+            }
+        }
+    }
+
+    // Estimated totals
+    double wTotal = 0.0;
+    double zTotal[NumberOfSimplexValues];
+    for (int i = 0; i < NumberOfSimplexValues; i++) {
+        zTotal[i] = 0.0;
+    }
+
+    for (int h = 0; h < numStrata; h++) {
+        double weight = stratumSize[h] / cellsPerStratum;
+
+        for (int k = 0; k < cellsPerStratum; k++) {
+            int sample = h * cellsPerStratum + k;
+
+            wTotal += w[sample] * weight;
+            for (int i = 0; i < NumberOfSimplexValues; i++) {
+                zTotal[i] += z[i][sample] * weight;
+            }
+        }
+    }
+
+    size = wTotal;
+
+    if (wTotal <= 0.0) return;
+
+    double r[NumberOfSimplexValues];
+    for (int i = 0; i < NumberOfSimplexValues; i++) {
+        r[i] = zTotal[i] / wTotal;
+    }
+    double r2 = r[XDirectionValue] * r[XDirectionValue] + r[YDirectionValue] * r[YDirectionValue];
+
+    // Variance of the estimated totals, using the linearized ratio estimator for the means.
+    // The angle residual is the linearized change in atan2 of the mean direction, in radians.
+    double sizeVariance = 0.0;
+    double meanVariance[NumberOfSimplexValues];
+    for (int i = 0; i < NumberOfSimplexValues; i++) {
+        meanVariance[i] = 0.0;
+    }
+
+    std::vector<double> d(cellsPerStratum);
+
+    for (int h = 0; h < numStrata; h++) {
+        double f = stratumSize[h] * stratumSize[h] / cellsPerStratum;
+
+        for (int i = -1; i < NumberOfSimplexValues; i++) {
+            for (int k = 0; k < cellsPerStratum; k++) {
+                int sample = h * cellsPerStratum + k;
+
+                if (i < 0) {
+                    d[k] = w[sample];
+                }
+                else if (i == XYAngleValue) {
+                    double dx = z[XDirectionValue][sample] - r[XDirectionValue] * w[sample];
+                    double dy = z[YDirectionValue][sample] - r[YDirectionValue] * w[sample];
+                    d[k] = r2 > 0.0 ? (r[XDirectionValue] * dy - r[YDirectionValue] * dx) / r2 : 0.0;
+                }
+                else {
+                    d[k] = z[i][sample] - r[i] * w[sample];
+                }
+            }
+
+            double mean = 0.0;
+            for (int k = 0; k < cellsPerStratum; k++) {
+                mean += d[k];
+            }
+            mean /= cellsPerStratum;
+
+            double variance = 0.0;
+            for (int k = 0; k < cellsPerStratum; k++) {
+                variance += (d[k] - mean) * (d[k] - mean);
+            }
+            variance /= cellsPerStratum - 1;
+
+            if (i < 0) sizeVariance += f * variance;
+            else meanVariance[i] += f * variance;
+        }
+    }
+
+    sizeError = z95 * sqrt(sizeVariance);
+    for (int i = 0; i < NumberOfSimplexValues; i++) {
+        meanError[i] = z95 * sqrt(meanVariance[i]) / wTotal;
+    }
+    meanError[XYAngleValue] = vtkMath::DegreesFromRadians(meanError[XYAngleValue]);
+}
+
+
+VTK_THREAD_RETURN_TYPE ProgressiveStatistics::ThreadFunction(void* arg) {
+    vtkMultiThreader::ThreadInfo* info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+    ProgressiveStatistics* self = static_cast<ProgressiveStatistics*>(info->UserData);
+
+    self->background.Update();
+
+    self->lock->Lock();
+    self->backgroundDone = true;
+    self->lock->Unlock();
+
+    return VTK_THREAD_RETURN_VALUE;
+}
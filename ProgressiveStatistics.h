@@ -0,0 +1,94 @@
+/*=========================================================================
+
+  Name:        ProgressiveStatistics.h
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+  Description: Statistics that are first estimated from a stratified
+               random sample of cells, with confidence intervals, and
+               then computed exactly in a background thread.
+
+=========================================================================*/
+
+
+#ifndef PROGRESSIVESTATISTICS_H
+#define PROGRESSIVESTATISTICS_H
+
+
+#include "DataSetStatistics.h"
+#include "RegionStatistics.h"
+
+#include <vtkMultiThreader.h>
+
+class vtkDataSet;
+class vtkMutexLock;
+
+
+class ProgressiveStatistics {
+public:
+    ProgressiveStatistics();
+    ~ProgressiveStatistics();
+
+    // Estimate the statistics from a sample and start computing the exact
+    // statistics in the background.  Small data sets are computed exactly
+    // right away.  Any previous background computation is stopped.
+    void Start(vtkDataSet* data);
+
+    // Compute the exact statistics now, without a background thread
+    void Compute(vtkDataSet* data);
+
+    // Stop the background computation, waiting for the thread to finish
+    void Stop();
+
+    // Wait for the background computation to finish, so the statistics are
+    // exact.  Call from the main thread.
+    void Finish();
+
+    // Returns true once when the exact statistics have become available.
+    // Call from the main thread, e.g. from a timer.
+    bool Poll();
+
+    // Whether the current statistics are exact or an estimate
+    bool IsExact();
+
+    // Statistics of the sample, or the exact statistics.  The mean is
+    // an estimate of the mean of all cells.
+    RegionStatistics& GetStatistics();
+
+    // Estimated total area/volume
+    double GetSize();
+
+    // Half-width of the 95% confidence interval, 0 when exact
+    double GetSizeError();
+    double GetMeanError(int value);
+
+protected:
+    RegionStatistics current;
+    double size;
+    double sizeError;
+    double meanError[NumberOfSimplexValues];
+    bool exact;
+
+    // Background computation
+    vtkMultiThreader* threader;
+    int threadId;
+    vtkMutexLock* lock;
+    vtkDataSet* input;
+    DataSetStatistics background;
+    bool backgroundDone;
+
+    void Estimate(vtkDataSet* data);
+
+    static VTK_THREAD_RETURN_TYPE ThreadFunction(void* arg);
+};
+
+
+#endif
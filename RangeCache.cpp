@@ -0,0 +1,172 @@
+/*=========================================================================
+
+  Name:        RangeCache.cpp
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+  Description: Caches the ranges of arrays and the bounds of data sets,
+               computing all components of an array in one multithreaded
+               pass, and recomputing only when the array is modified.
+
+=========================================================================*/
+
+
+#include "RangeCache.h"
+
+#include <vtkDataArray.h>
+#include <vtkDataSet.h>
+#include <vtkPoints.h>
+#include <vtkPointSet.h>
+
+
+// Arrays to keep ranges for
+static const int maxEntries = 16;
+
+
+// Range of each component of a block of tuples
+template <class T>
+static void BlockRange(const T* values, vtkIdType n, int numComponents, double* ranges) {
+    for (vtkIdType i = 0; i < n; i++) {
+        for (int j = 0; j < numComponents; j++) {
+            double v = values[i * numComponents + j];
+            ranges[j * 2] = v < ranges[j * 2] ? v : ranges[j * 2];
+            ranges[j * 2 + 1] = v > ranges[j * 2 + 1] ? v : ranges[j * 2 + 1];
+        }
+    }
+}
+
+
+RangeCache::RangeCache() {
+    input = NULL;
+}
+
+
+void RangeCache::GetRange(vtkDataArray* array, int component, double range[2]) {
+    Entry& entry = GetEntry(array);
+
+    if (component < 0 || component * 2 >= (int)entry.ranges.size() || 
+        entry.ranges[component * 2] > entry.ranges[component * 2 + 1]) {
+        // No values
+        range[0] = 0.0;
+        range[1] = 1.0;
+        return;
+    }
+
+    range[0] = entry.ranges[component * 2];
+    range[1] = entry.ranges[component * 2 + 1];
+}
+
+
+void RangeCache::GetBounds(vtkDataSet* data, double bounds[6]) {
+    vtkPointSet* pointSet = vtkPointSet::SafeDownCast(data);
+    if (!pointSet || !pointSet->GetPoints() || pointSet->GetNumberOfPoints() == 0) {
+        data->GetBounds(bounds);
+        return;
+    }
+
+    vtkDataArray* points = pointSet->GetPoints()->GetData();
+    for (int i = 0; i < 3; i++) {
+        GetRange(points, i, bounds + i * 2);
+    }
+}
+
+
+RangeCache::Entry& RangeCache::GetEntry(vtkDataArray* array) {
+    for (int i = 0; i < (int)entries.size(); i++) {
+        if (entries[i].array == array) {
+            if (entries[i].time == array->GetMTime()) return entries[i];
+
+            // Modified, so recompute
+            entries.erase(entries.begin() + i);
+            break;
+        }
+    }
+
+    // Replace the oldest
+    if ((int)entries.size() >= maxEntries) {
+        entries.erase(entries.begin());
+    }
+
+    input = array;
+
+    vtkMultiThreader* threader = vtkMultiThreader::New();
+    int numThreads = threader->GetNumberOfThreads();
+    int numComponents = array->GetNumberOfComponents();
+
+    std::vector<double> empty(numComponents * 2);
+    for (int i = 0; i < numComponents; i++) {
+        empty[i * 2] = VTK_DOUBLE_MAX;
+        empty[i * 2 + 1] = -VTK_DOUBLE_MAX;
+    }
+    threadRanges.assign(numThreads, empty);
+
+    threader->SetSingleMethod(ThreadFunction, this);
+    threader->SingleMethodExecute();
+    threader->Delete();
+
+    // Combine the results from each thread
+    Entry entry;
+    entry.array = array;
+    entry.time = array->GetMTime();
+    entry.ranges = empty;
+
+    for (int i = 0; i < numThreads; i++) {
+        for (int j = 0; j < numComponents; j++) {
+            double* r = &threadRanges[i][j * 2];
+            entry.ranges[j * 2] = r[0] < entry.ranges[j * 2] ? r[0] : entry.ranges[j * 2];
+            entry.ranges[j * 2 + 1] = r[1] > entry.ranges[j * 2 + 1] ? r[1] : entry.ranges[j * 2 + 1];
+        }
+    }
+
+    threadRanges.clear();
+    input = NULL;
+
+    entries.push_back(entry);
+
+    return entries.back();
+}
+
+
+VTK_THREAD_RETURN_TYPE RangeCache::ThreadFunction(void* arg) {
+    vtkMultiThreader::ThreadInfo* info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+    RangeCache* self = static_cast<RangeCache*>(info->UserData);
+
+    self->ThreadExecute(info->ThreadID, info->NumberOfThreads);
+
+    return VTK_THREAD_RETURN_VALUE;
+}
+
+void RangeCache::ThreadExecute(int thread, int numThreads) {
+    vtkIdType numTuples = input->GetNumberOfTuples();
+    vtkIdType start = numTuples * thread / numThreads;
+    vtkIdType end = numTuples * (thread + 1) / numThreads;
+    if (start >= end) return;
+
+    int numComponents = input->GetNumberOfComponents();
+    double* ranges = &threadRanges[thread][0];
+
+    // Read float and double arrays directly
+    if (input->GetDataType() == VTK_FLOAT) {
+        const float* values = static_cast<const float*>(input->GetVoidPointer(start * numComponents));
+        BlockRange(values, end - start, numComponents, ranges);
+    }
+    else if (input->GetDataType() == VTK_DOUBLE) {
+        const double* values = static_cast<const double*>(input->GetVoidPointer(start * numComponents));
+        BlockRange(values, end - start, numComponents, ranges);
+    }
+    else {
+        std::vector<double> tuple(numComponents);
+        for (vtkIdType i = start; i < end; i++) {
+            input->GetTuple(i, &tuple[0]);
+            BlockRange(&tuple[0], 1, numComponents, ranges);
+        }
+    }
+}
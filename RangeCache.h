@@ -0,0 +1,65 @@
+/*=========================================================================
+
+  Name:        RangeCache.h
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+  Description: Caches the ranges of arrays and the bounds of data sets,
+               computing all components of an array in one multithreaded
+               pass, and recomputing only when the array is modified.
+
+=========================================================================*/
+
+
+#ifndef RANGECACHE_H
+#define RANGECACHE_H
+
+
+#include <vtkMultiThreader.h>
+
+#include <vector>
+
+class vtkDataArray;
+class vtkDataSet;
+
+
+class RangeCache {
+public:
+    RangeCache();
+
+    // Range of a component of the array
+    void GetRange(vtkDataArray* array, int component, double range[2]);
+
+    // Bounds of the data, from the range of its points
+    void GetBounds(vtkDataSet* data, double bounds[6]);
+
+protected:
+    struct Entry {
+        vtkDataArray* array;
+        unsigned long time;
+
+        // Min and max for each component
+        std::vector<double> ranges;
+    };
+    std::vector<Entry> entries;
+
+    Entry& GetEntry(vtkDataArray* array);
+
+    // Per-thread results
+    vtkDataArray* input;
+    std::vector< std::vector<double> > threadRanges;
+
+    static VTK_THREAD_RETURN_TYPE ThreadFunction(void* arg);
+    void ThreadExecute(int thread, int numThreads);
+};
+
+
+#endif
@@ -0,0 +1,146 @@
+/*=========================================================================
+
+  Name:        RegionStatistics.cpp
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+  Description: Accumulates area/volume-weighted statistics of the wind
+               data for a region.  Partial results from different
+               threads can be combined with Add().
+
+=========================================================================*/
+
+
+#include "RegionStatistics.h"
+
+#include <vtkMath.h>
+
+#include <math.h>
+
+
+RegionStatistics::RegionStatistics() {
+    Initialize();
+}
+
+
+void RegionStatistics::Initialize() {
+    numberOfCells = 0;
+    size = 0.0;
+
+    for (int i = 0; i < NumberOfSimplexValues; i++) {
+        min[i] = VTK_DOUBLE_MAX;
+        max[i] = -VTK_DOUBLE_MAX;
+        sum[i] = 0.0;
+    }
+}
+
+
+void RegionStatistics::AddSimplex(const Simplex& s, double measure) {
+    for (int i = 0; i < NumberOfSimplexValues; i++) {
+        // Cell value is the average of the point values, as with vtkPointDataToCellData
+        double cellValue = 0.0;
+        for (int j = 0; j < s.numberOfPoints; j++) {
+            double v = s.p[j].v[i];
+
+            min[i] = v < min[i] ? v : min[i];
+            max[i] = v > max[i] ? v : max[i];
+
+            cellValue += v;
+        }
+        cellValue /= s.numberOfPoints;
+
+        sum[i] += cellValue * measure;
+    }
+
+    size += measure;
+    numberOfCells++;
+}
+
+
+void RegionStatistics::Add(const RegionStatistics& other) {
+    for (int i = 0; i < NumberOfSimplexValues; i++) {
+        min[i] = other.min[i] < min[i] ? other.min[i] : min[i];
+        max[i] = other.max[i] > max[i] ? other.max[i] : max[i];
+        sum[i] += other.sum[i];
+    }
+
+    size += other.size;
+    numberOfCells += other.numberOfCells;
+}
+
+
+vtkIdType RegionStatistics::GetNumberOfCells() {
+    return numberOfCells;
+}
+
+double RegionStatistics::GetSize() {
+    return size;
+}
+
+
+double RegionStatistics::GetMin(int value) {
+    return numberOfCells > 0 ? min[value] : 0.0;
+}
+
+double RegionStatistics::GetMax(int value) {
+    return numberOfCells > 0 ? max[value] : 0.0;
+}
+
+
+double RegionStatistics::GetMean(int value) {
+    if (size <= 0.0) return 0.0;
+
+    if (value == XYAngleValue) {
+        double xMean = sum[XDirectionValue] / size;
+        double yMean = sum[YDirectionValue] / size;
+
+        // Calculate the angle of this vector from 0 to 360 degrees, with positive Y as 0 degrees
+        // We want the *incoming* wind angle, which is the direction of the negative wind vector.
+        // Use atan2, as the mean vector is shorter than unit length unless all directions agree.
+        double mean = 270.0 - vtkMath::DegreesFromRadians(atan2(yMean, xMean));
+        return mean >= 360.0 ? mean - 360.0 : mean;
+    }
+
+    return sum[value] / size;
+}
+
+double RegionStatistics::GetCircularVariance() {
+    if (size <= 0.0) return 0.0;
+
+    // One minus the length of the mean direction vector
+    double xMean = sum[XDirectionValue] / size;
+    double yMean = sum[YDirectionValue] / size;
+
+    double variance = 1.0 - sqrt(xMean * xMean + yMean * yMean);
+    return variance < 0.0 ? 0.0 : variance;
+}
+
+
+void RegionStatistics::WriteHeader(std::ostream& out) {
+    out << "Cells, Area/Volume, "
+        << "XY Magnitude Min, XY Magnitude Max, XY Magnitude Mean, "
+        << "XY Angle Min, XY Angle Max, XY Angle Mean, XY Angle Circular Variance, "
+        << "Z Component Min, Z Component Max, Z Component Mean";
+}
+
+void RegionStatistics::Write(std::ostream& out) {
+    out << GetNumberOfCells() << ", " << GetSize();
+
+    int values[3] = { XYMagnitudeValue, XYAngleValue, ZComponentValue };
+    for (int i = 0; i < 3; i++) {
+        out << ", " << GetMin(values[i])
+            << ", " << GetMax(values[i])
+            << ", " << GetMean(values[i]);
+
+        if (values[i] == XYAngleValue) out << ", " << GetCircularVariance();
+    }
+}
+
@@ -0,0 +1,76 @@
+/*=========================================================================
+
+  Name:        RegionStatistics.h
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+  Description: Accumulates area/volume-weighted statistics of the wind
+               data for a region.  Partial results from different
+               threads can be combined with Add().
+
+=========================================================================*/
+
+
+#ifndef REGIONSTATISTICS_H
+#define REGIONSTATISTICS_H
+
+
+#include "BoxClipper.h"
+
+#include <vtkType.h>
+
+#include <ostream>
+
+
+class RegionStatistics {
+public:
+    RegionStatistics();
+
+    void Initialize();
+
+    // Add a triangle or tetrahedron, with its area or volume
+    void AddSimplex(const Simplex& s, double measure);
+
+    // Combine with another partial result
+    void Add(const RegionStatistics& other);
+
+    vtkIdType GetNumberOfCells();
+
+    // Total area or volume
+    double GetSize();
+
+    // Min and max of the point values
+    double GetMin(int value);
+    double GetMax(int value);
+
+    // Mean of the cell values, weighted by area/volume.  The mean
+    // angle is computed from the XY direction vectors.
+    double GetMean(int value);
+
+    // Circular variance of the angle, from 0 for a single direction to 1
+    // for directions that cancel out
+    double GetCircularVariance();
+
+    // Write the statistics as comma-separated columns
+    static void WriteHeader(std::ostream& out);
+    void Write(std::ostream& out);
+
+protected:
+    vtkIdType numberOfCells;
+    double size;
+
+    double min[NumberOfSimplexValues];
+    double max[NumberOfSimplexValues];
+    double sum[NumberOfSimplexValues];
+};
+
+
+#endif
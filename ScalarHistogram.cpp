@@ -0,0 +1,220 @@
+/*=========================================================================
+
+  Name:        ScalarHistogram.cpp
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+  Description: Histogram of a scalar array, computed in two multithreaded
+               passes, for finding percentiles and equalizing color maps.
+
+=========================================================================*/
+
+
+#include "ScalarHistogram.h"
+
+#include <vtkDataArray.h>
+
+
+// Enough bins for percentiles and equalization, while staying in cache
+static const int numBins = 4096;
+
+// Fraction of values at each end that may be left out of the bins when narrowing
+static const double outlierFraction = 0.001;
+
+// Count a block of values, with bins 0 and numBins + 1 for values outside the bin range
+template <class T>
+static void BlockCount(const T* values, vtkIdType n, int stride, double min, double scale, vtkIdType* counts) {
+    for (vtkIdType i = 0; i < n; i++) {
+        double x = (values[i * stride] - min) * scale;
+        int bin = x < 0.0 ? 0 : x >= numBins ? numBins + 1 : (int)x + 1;
+        counts[bin]++;
+    }
+}
+
+
+ScalarHistogram::ScalarHistogram() {
+    array = NULL;
+    arrayTime = 0;
+
+    range[0] = binRange[0] = 0.0;
+    range[1] = binRange[1] = 1.0;
+}
+
+
+void ScalarHistogram::Compute(vtkDataArray* data, const double dataRange[2]) {
+    array = data;
+    arrayTime = data ? data->GetMTime() : 0;
+
+    range[0] = binRange[0] = 0.0;
+    range[1] = binRange[1] = 1.0;
+    cumulative.clear();
+
+    if (data == NULL || data->GetNumberOfTuples() == 0) return;
+
+    vtkMultiThreader* threader = vtkMultiThreader::New();
+    threader->SetSingleMethod(ThreadFunction, this);
+
+    range[0] = dataRange[0];
+    range[1] = dataRange[1];
+
+    // Counts
+    binRange[0] = range[0];
+    binRange[1] = range[1];
+    Count(threader);
+
+    // If outliers squeeze the data into a few bins, count again over the rest
+    double low = GetValue(outlierFraction);
+    double high = GetValue(1.0 - outlierFraction);
+    if (high > low && (high - low) * 16.0 < range[1] - range[0]) {
+        binRange[0] = low;
+        binRange[1] = high;
+        Count(threader);
+    }
+
+    threader->Delete();
+
+    threadCounts.clear();
+}
+
+
+void ScalarHistogram::Count(vtkMultiThreader* threader) {
+    int numThreads = threader->GetNumberOfThreads();
+    threadCounts.assign(numThreads, std::vector<vtkIdType>(numBins + 2, 0));
+
+    threader->SingleMethodExecute();
+
+    cumulative.assign(numBins + 2, 0);
+    vtkIdType total = 0;
+    for (int i = 0; i < numBins + 2; i++) {
+        for (int j = 0; j < numThreads; j++) {
+            total += threadCounts[j][i];
+        }
+        cumulative[i] = total;
+    }
+}
+
+
+bool ScalarHistogram::IsCurrent(vtkDataArray* data) {
+    return data != NULL && data == array && data->GetMTime() == arrayTime;
+}
+
+
+void ScalarHistogram::GetRange(double r[2]) {
+    r[0] = range[0];
+    r[1] = range[1];
+}
+
+
+double ScalarHistogram::GetValue(double fraction) {
+    if (cumulative.empty() || range[1] <= range[0]) return range[0];
+
+    double target = fraction * cumulative[numBins + 1];
+
+    // First bin reaching the target, interpolating within it
+    int bin = 0;
+    while (bin < numBins + 1 && cumulative[bin] < target) bin++;
+
+    double value[2];
+    double count[2];
+    GetBinEnds(bin, value, count);
+
+    double t = count[1] > count[0] ? (target - count[0]) / (count[1] - count[0]) : 0.0;
+    t = t < 0.0 ? 0.0 : t > 1.0 ? 1.0 : t;
+
+    return value[0] + (value[1] - value[0]) * t;
+}
+
+double ScalarHistogram::GetFraction(double value) {
+    if (cumulative.empty() || range[1] <= range[0]) return value < range[0] ? 0.0 : 1.0;
+
+    if (value <= range[0]) return 0.0;
+    if (value >= range[1]) return 1.0;
+
+    int bin;
+    if (value < binRange[0]) {
+        bin = 0;
+    }
+    else if (value >= binRange[1]) {
+        bin = numBins + 1;
+    }
+    else {
+        bin = (int)((value - binRange[0]) / (binRange[1] - binRange[0]) * numBins) + 1;
+        bin = bin > numBins ? numBins : bin;
+    }
+
+    double v[2];
+    double count[2];
+    GetBinEnds(bin, v, count);
+
+    double t = v[1] > v[0] ? (value - v[0]) / (v[1] - v[0]) : 0.0;
+    t = t < 0.0 ? 0.0 : t > 1.0 ? 1.0 : t;
+
+    return (count[0] + (count[1] - count[0]) * t) / cumulative[numBins + 1];
+}
+
+
+void ScalarHistogram::GetBinEnds(int bin, double value[2], double count[2]) {
+    double binWidth = (binRange[1] - binRange[0]) / numBins;
+
+    if (bin == 0) {
+        value[0] = range[0];
+        value[1] = binRange[0];
+    }
+    else if (bin == numBins + 1) {
+        value[0] = binRange[1];
+        value[1] = range[1];
+    }
+    else {
+        value[0] = binRange[0] + (bin - 1) * binWidth;
+        value[1] = value[0] + binWidth;
+    }
+
+    count[0] = bin > 0 ? (double)cumulative[bin - 1] : 0.0;
+    count[1] = (double)cumulative[bin];
+}
+
+
+VTK_THREAD_RETURN_TYPE ScalarHistogram::ThreadFunction(void* arg) {
+    vtkMultiThreader::ThreadInfo* info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+    ScalarHistogram* self = static_cast<ScalarHistogram*>(info->UserData);
+
+    self->ThreadExecute(info->ThreadID, info->NumberOfThreads);
+
+    return VTK_THREAD_RETURN_VALUE;
+}
+
+void ScalarHistogram::ThreadExecute(int thread, int numThreads) {
+    vtkIdType numValues = array->GetNumberOfTuples();
+    vtkIdType start = numValues * thread / numThreads;
+    vtkIdType end = numValues * (thread + 1) / numThreads;
+    if (start >= end) return;
+
+    vtkIdType n = end - start;
+    int stride = array->GetNumberOfComponents();
+
+    double scale = binRange[1] > binRange[0] ? numBins / (binRange[1] - binRange[0]) : 0.0;
+
+    // Read float and double arrays directly
+    if (array->GetDataType() == VTK_FLOAT) {
+        const float* values = static_cast<const float*>(array->GetVoidPointer(start * stride));
+        BlockCount(values, n, stride, binRange[0], scale, &threadCounts[thread][0]);
+    }
+    else if (array->GetDataType() == VTK_DOUBLE) {
+        const double* values = static_cast<const double*>(array->GetVoidPointer(start * stride));
+        BlockCount(values, n, stride, binRange[0], scale, &threadCounts[thread][0]);
+    }
+    else {
+        for (vtkIdType i = start; i < end; i++) {
+            double v = array->GetComponent(i, 0);
+            BlockCount(&v, 1, 1, binRange[0], scale, &threadCounts[thread][0]);
+        }
+    }
+}
@@ -0,0 +1,78 @@
+/*=========================================================================
+
+  Name:        ScalarHistogram.h
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+  Description: Histogram of a scalar array, computed in two multithreaded
+               passes, for finding percentiles and equalizing color maps.
+
+=========================================================================*/
+
+
+#ifndef SCALARHISTOGRAM_H
+#define SCALARHISTOGRAM_H
+
+
+#include <vtkMultiThreader.h>
+#include <vtkType.h>
+
+#include <vector>
+
+class vtkDataArray;
+
+
+class ScalarHistogram {
+public:
+    ScalarHistogram();
+
+    // Compute the histogram of the first component of the array, given the
+    // range of that component, e.g. from RangeCache
+    void Compute(vtkDataArray* data, const double dataRange[2]);
+
+    // True if computed from the array as it is now
+    bool IsCurrent(vtkDataArray* data);
+
+    void GetRange(double range[2]);
+
+    // Value below which the fraction of the values lie, e.g. 0.01 for the 1st percentile
+    double GetValue(double fraction);
+
+    // Fraction of the values below the value
+    double GetFraction(double value);
+
+protected:
+    vtkDataArray* array;
+    unsigned long arrayTime;
+
+    double range[2];
+
+    // Range covered by the bins, narrowed if outliers would leave most bins empty
+    double binRange[2];
+
+    // Cumulative count at the end of each bin, with bins for values below and
+    // above the bin range at the start and end
+    std::vector<vtkIdType> cumulative;
+
+    // Per-thread counts
+    std::vector< std::vector<vtkIdType> > threadCounts;
+
+    void Count(vtkMultiThreader* threader);
+
+    // Value and cumulative count at each end of a bin
+    void GetBinEnds(int bin, double value[2], double count[2]);
+
+    static VTK_THREAD_RETURN_TYPE ThreadFunction(void* arg);
+    void ThreadExecute(int thread, int numThreads);
+};
+
+
+#endif
@@ -0,0 +1,164 @@
+/*=========================================================================
+
+  Name:        ScreenshotQueue.cpp
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+  Description: Queue of captured images that are encoded as PNG files by
+               worker threads, so rendering can continue while writing.
+
+=========================================================================*/
+
+
+#include "ScreenshotQueue.h"
+
+#include <vtkConditionVariable.h>
+#include <vtkImageData.h>
+#include <vtkMutexLock.h>
+#include <vtkPNGWriter.h>
+
+
+ScreenshotQueue::ScreenshotQueue() {
+    numberOfPending = 0;
+    stop = false;
+
+    threader = vtkMultiThreader::New();
+
+    lock = vtkMutexLock::New();
+    frameAdded = vtkConditionVariable::New();
+    frameWritten = vtkConditionVariable::New();
+
+    // Leave a thread for rendering.  Workers are started with the first image.
+    int numThreads = threader->GetNumberOfThreads() - 1;
+    threadIds.resize(numThreads < 1 ? 1 : numThreads, -1);
+
+    maximumPending = (int)threadIds.size() * 2;
+}
+
+ScreenshotQueue::~ScreenshotQueue() {
+    Finish();
+
+    lock->Lock();
+    stop = true;
+    frameAdded->Broadcast();
+    lock->Unlock();
+
+    for (int i = 0; i < (int)threadIds.size(); i++) {
+        if (threadIds[i] >= 0) threader->TerminateThread(threadIds[i]);
+    }
+
+    threader->Delete();
+
+    lock->Delete();
+    frameAdded->Delete();
+    frameWritten->Delete();
+}
+
+
+void ScreenshotQueue::SetMaximumPending(int maximum) {
+    lock->Lock();
+    maximumPending = maximum < 1 ? 1 : maximum;
+    lock->Unlock();
+}
+
+int ScreenshotQueue::GetMaximumPending() {
+    return maximumPending;
+}
+
+
+void ScreenshotQueue::Add(vtkImageData* image, const char* fileName) {
+    if (threadIds[0] < 0) {
+        for (int i = 0; i < (int)threadIds.size(); i++) {
+            threadIds[i] = threader->SpawnThread(ThreadFunction, this);
+        }
+    }
+
+    // Copy before waiting, so the caller can carry on with the image
+    Frame frame;
+    frame.image = vtkImageData::New();
+    frame.image->DeepCopy(image);
+    frame.fileName = fileName;
+
+    lock->Lock();
+
+    while (numberOfPending >= maximumPending) {
+        frameWritten->Wait(lock);
+    }
+
+    frames.push_back(frame);
+    numberOfPending++;
+    frameAdded->Signal();
+
+    lock->Unlock();
+}
+
+
+void ScreenshotQueue::Finish() {
+    lock->Lock();
+
+    while (numberOfPending > 0) {
+        frameWritten->Wait(lock);
+    }
+
+    lock->Unlock();
+}
+
+
+int ScreenshotQueue::GetNumberOfPending() {
+    lock->Lock();
+    int n = numberOfPending;
+    lock->Unlock();
+
+    return n;
+}
+
+
+VTK_THREAD_RETURN_TYPE ScreenshotQueue::ThreadFunction(void* arg) {
+    vtkMultiThreader::ThreadInfo* info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+    ScreenshotQueue* self = static_cast<ScreenshotQueue*>(info->UserData);
+
+    self->ThreadExecute();
+
+    return VTK_THREAD_RETURN_VALUE;
+}
+
+void ScreenshotQueue::ThreadExecute() {
+    lock->Lock();
+
+    while (true) {
+        while (frames.empty() && !stop) {
+            frameAdded->Wait(lock);
+        }
+
+        if (frames.empty()) break;
+
+        Frame frame = frames.front();
+        frames.pop_front();
+
+        lock->Unlock();
+
+        // The image is only referenced by this thread now
+        vtkPNGWriter* writer = vtkPNGWriter::New();
+        writer->SetInput(frame.image);
+        writer->SetFileName(frame.fileName.c_str());
+        writer->Write();
+        writer->Delete();
+
+        frame.image->Delete();
+
+        lock->Lock();
+
+        numberOfPending--;
+        frameWritten->Broadcast();
+    }
+
+    lock->Unlock();
+}
@@ -0,0 +1,79 @@
+/*=========================================================================
+
+  Name:        ScreenshotQueue.h
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+  Description: Queue of captured images that are encoded as PNG files by
+               worker threads, so rendering can continue while writing.
+
+=========================================================================*/
+
+
+#ifndef SCREENSHOTQUEUE_H
+#define SCREENSHOTQUEUE_H
+
+
+#include <vtkMultiThreader.h>
+
+#include <deque>
+#include <string>
+#include <vector>
+
+class vtkConditionVariable;
+class vtkImageData;
+class vtkMutexLock;
+
+
+class ScreenshotQueue {
+public:
+    ScreenshotQueue();
+
+    // Writes any pending images
+    ~ScreenshotQueue();
+
+    // Maximum number of images queued or being written.  Add() waits
+    // for an image to be written when this is reached.
+    void SetMaximumPending(int maximum);
+    int GetMaximumPending();
+
+    // Copy the image and queue it to be written as a PNG file
+    void Add(vtkImageData* image, const char* fileName);
+
+    // Wait for all queued images to be written
+    void Finish();
+
+    int GetNumberOfPending();
+
+protected:
+    struct Frame {
+        vtkImageData* image;
+        std::string fileName;
+    };
+
+    std::deque<Frame> frames;
+    int numberOfPending;
+    int maximumPending;
+    bool stop;
+
+    vtkMultiThreader* threader;
+    std::vector<int> threadIds;
+
+    vtkMutexLock* lock;
+    vtkConditionVariable* frameAdded;
+    vtkConditionVariable* frameWritten;
+
+    static VTK_THREAD_RETURN_TYPE ThreadFunction(void* arg);
+    void ThreadExecute();
+};
+
+
+#endif
@@ -0,0 +1,124 @@
+/*=========================================================================
+
+  Name:        SimplexReader.cpp
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+  Description: Reads the cells of a data set as triangles and tetrahedra,
+               with the wind point data attached to each vertex.  Each
+               thread should use its own reader.
+
+=========================================================================*/
+
+
+#include "SimplexReader.h"
+
+#include <vtkCellType.h>
+#include <vtkDataArray.h>
+#include <vtkDataSet.h>
+#include <vtkGenericCell.h>
+#include <vtkIdList.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+
+
+SimplexReader::SimplexReader(vtkDataSet* dataSet) : data(dataSet) {
+    // Look up arrays by name, as the active scalars depend on the current vector data
+    vtkPointData* pd = data->GetPointData();
+
+    vectors = pd->GetVectors();
+    if (!vectors) vectors = pd->GetArray("velocityNormXYDirection");
+
+    values[XYMagnitudeValue] = pd->GetArray("velocityNormXYMag");
+    values[XYAngleValue] = pd->GetArray("velocityNormXYAngle");
+    values[ZComponentValue] = pd->GetArray("velocityNormZ");
+    values[XDirectionValue] = vectors;
+    values[YDirectionValue] = vectors;
+
+    pointIds = vtkIdList::New();
+    cell = vtkGenericCell::New();
+    triangleIds = vtkIdList::New();
+    trianglePoints = vtkPoints::New();
+}
+
+SimplexReader::~SimplexReader() {
+    pointIds->Delete();
+    cell->Delete();
+    triangleIds->Delete();
+    trianglePoints->Delete();
+}
+
+
+void SimplexReader::Prepare(vtkDataSet* data) {
+    if (data->GetNumberOfCells() == 0) return;
+
+    // The first call to any of these can build cell information
+    vtkIdList* ids = vtkIdList::New();
+    vtkGenericCell* c = vtkGenericCell::New();
+
+    data->GetCellType(0);
+    data->GetCellPoints(0, ids);
+    data->GetCell(0, c);
+
+    ids->Delete();
+    c->Delete();
+}
+
+
+void SimplexReader::GetSimplices(vtkIdType cellId, std::vector<Simplex>& out) {
+    int type = data->GetCellType(cellId);
+
+    Simplex s;
+
+    if (type == VTK_TETRA || type == VTK_TRIANGLE) {
+        // Fast path for cells that are already simplices
+        data->GetCellPoints(cellId, pointIds);
+
+        s.numberOfPoints = pointIds->GetNumberOfIds();
+        for (int i = 0; i < s.numberOfPoints; i++) {
+            GetVertex(pointIds->GetId(i), s.p[i]);
+        }
+
+        out.push_back(s);
+    }
+    else {
+        data->GetCell(cellId, cell);
+
+        int dimension = cell->GetCellDimension();
+        if (dimension < 2) return;
+
+        cell->Triangulate(0, triangleIds, trianglePoints);
+
+        s.numberOfPoints = dimension == 3 ? 4 : 3;
+        for (int i = 0; i + s.numberOfPoints <= triangleIds->GetNumberOfIds(); i += s.numberOfPoints) {
+            for (int j = 0; j < s.numberOfPoints; j++) {
+                GetVertex(triangleIds->GetId(i + j), s.p[j]);
+            }
+
+            out.push_back(s);
+        }
+    }
+}
+
+
+vtkIdType SimplexReader::GetNumberOfCells() {
+    return data->GetNumberOfCells();
+}
+
+
+void SimplexReader::GetVertex(vtkIdType pointId, SimplexVertex& v) {
+    data->GetPoint(pointId, v.x);
+
+    for (int i = 0; i < NumberOfSimplexValues; i++) {
+        int component = i == YDirectionValue ? 1 : 0;
+        v.v[i] = values[i] ? values[i]->GetComponent(pointId, component) : 0.0;
+    }
+}
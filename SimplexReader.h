@@ -0,0 +1,68 @@
+/*=========================================================================
+
+  Name:        SimplexReader.h
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+  Description: Reads the cells of a data set as triangles and tetrahedra,
+               with the wind point data attached to each vertex.  Each
+               thread should use its own reader.
+
+=========================================================================*/
+
+
+#ifndef SIMPLEXREADER_H
+#define SIMPLEXREADER_H
+
+
+#include "BoxClipper.h"
+
+#include <vtkType.h>
+
+class vtkDataArray;
+class vtkDataSet;
+class vtkGenericCell;
+class vtkIdList;
+class vtkPoints;
+
+
+class SimplexReader {
+public:
+    SimplexReader(vtkDataSet* data);
+    ~SimplexReader();
+
+    // Must be called from a single thread before readers are used from
+    // multiple threads, as vtkDataSet builds its cell links lazily
+    static void Prepare(vtkDataSet* data);
+
+    // Append the simplices making up the cell to the output
+    void GetSimplices(vtkIdType cellId, std::vector<Simplex>& out);
+
+    vtkIdType GetNumberOfCells();
+
+protected:
+    vtkDataSet* data;
+
+    // Point data
+    vtkDataArray* values[NumberOfSimplexValues];
+    vtkDataArray* vectors;
+
+    // Work space
+    vtkIdList* pointIds;
+    vtkGenericCell* cell;
+    vtkIdList* triangleIds;
+    vtkPoints* trianglePoints;
+
+    void GetVertex(vtkIdType pointId, SimplexVertex& v);
+};
+
+
+#endif
@@ -0,0 +1,216 @@
+/*=========================================================================
+
+  Name:        StreamingExporter.cpp
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+  Description: Exports cell values straight from the unclipped data,
+               one chunk of cells at a time, so memory use does not
+               grow with the size of the data.
+
+=========================================================================*/
+
+
+#include "StreamingExporter.h"
+
+#include "CSVWriter.h"
+#include "SimplexReader.h"
+
+#include <vtkDataSet.h>
+
+#include <fstream>
+#include <iostream>
+
+
+// Cells per chunk.  Memory use is a few rows' worth of doubles per cell.
+static const vtkIdType cellsPerChunk = 1 << 20;
+
+
+StreamingExporter::StreamingExporter() {
+    input = NULL;
+    value = XYMagnitudeValue;
+    sizeName = "Volume";
+
+    useBox = false;
+
+    chunkStart = 0;
+    chunkEnd = 0;
+}
+
+StreamingExporter::~StreamingExporter() {
+}
+
+
+void StreamingExporter::SetInput(vtkDataSet* data) {
+    input = data;
+}
+
+
+void StreamingExporter::SetValue(int simplexValue) {
+    value = simplexValue;
+}
+
+void StreamingExporter::SetSizeName(const char* name) {
+    sizeName = name;
+}
+
+
+void StreamingExporter::SetBox(const double center[3], const double size[3], double rotation, int clipType) {
+    clipper.SetBox(center, size, rotation, clipType);
+    useBox = true;
+}
+
+void StreamingExporter::RemoveBox() {
+    useBox = false;
+}
+
+
+bool StreamingExporter::Write(const char* fileName) {
+    if (input == NULL) return false;
+
+    std::string name(fileName);
+    std::string extension = name.size() >= 4 ? name.substr(name.size() - 4) : "";
+
+    if (extension == ".npz") {
+        std::cout << "Streaming export does not support .npz files, use .npy instead" << std::endl;
+        return false;
+    }
+
+    bool npy = extension == ".npy";
+    bool gzip = name.size() >= 3 && name.substr(name.size() - 3) == ".gz";
+
+    CellTable table;
+    table.Initialize(value, sizeName.c_str());
+
+    // Open the file and write the header
+    CSVWriter csv;
+    std::ofstream npyFile;
+    std::string descr;
+    size_t headerLength = 0;
+
+    if (npy) {
+        npyFile.open(fileName, std::ios::out | std::ios::binary);
+
+        if (!npyFile.good()) {
+            std::cout << "Could not open " << fileName << " for writing" << std::endl;
+            return false;
+        }
+
+        // Leave room to rewrite the header with the final number of rows
+        descr = table.NpyDescription();
+        headerLength = table.NpyHeader(descr, VTK_LARGE_ID).size();
+
+        std::string header = table.NpyHeader(descr, 0, headerLength);
+        npyFile.write(header.data(), header.size());
+    }
+    else {
+        csv.SetCompress(gzip);
+        if (!csv.Open(fileName, &table)) return false;
+    }
+
+    // Make the data safe to read from multiple threads
+    SimplexReader::Prepare(input);
+
+    vtkMultiThreader* threader = vtkMultiThreader::New();
+    threadTables.resize(threader->GetNumberOfThreads());
+
+    vtkIdType numCells = input->GetNumberOfCells();
+    vtkIdType numRows = 0;
+    bool ok = true;
+
+    for (chunkStart = 0; chunkStart < numCells && ok; chunkStart = chunkEnd) {
+        chunkEnd = chunkStart + cellsPerChunk < numCells ? chunkStart + cellsPerChunk : numCells;
+
+        // Triangulate and clip the chunk
+        threader->SetSingleMethod(ThreadFunction, this);
+        threader->SingleMethodExecute();
+
+        // Combine the rows in cell order and write them
+        table.Initialize(value, sizeName.c_str());
+        for (int i = 0; i < (int)threadTables.size(); i++) {
+            table.Add(threadTables[i]);
+        }
+
+        if (npy) {
+            table.WriteNpyRows(npyFile);
+            ok = npyFile.good();
+        }
+        else {
+            ok = csv.Append(&table);
+        }
+
+        numRows += table.GetNumberOfRows();
+    }
+
+    threader->Delete();
+    threadTables.clear();
+
+    if (npy) {
+        std::string header = table.NpyHeader(descr, numRows, headerLength);
+        npyFile.seekp(0);
+        npyFile.write(header.data(), header.size());
+        npyFile.close();
+
+        ok = ok && npyFile.good();
+        if (!ok) std::cout << "Error writing " << fileName << std::endl;
+    }
+    else {
+        ok = csv.Close() && ok;
+    }
+
+    return ok;
+}
+
+
+VTK_THREAD_RETURN_TYPE StreamingExporter::ThreadFunction(void* arg) {
+    vtkMultiThreader::ThreadInfo* info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+    StreamingExporter* self = static_cast<StreamingExporter*>(info->UserData);
+
+    self->ThreadExecute(info->ThreadID, info->NumberOfThreads);
+
+    return VTK_THREAD_RETURN_VALUE;
+}
+
+void StreamingExporter::ThreadExecute(int thread, int numThreads) {
+    CellTable& table = threadTables[thread];
+    table.Initialize(value, sizeName.c_str());
+
+    SimplexReader reader(input);
+
+    // Each thread needs its own clipper work space
+    BoxClipper box = clipper;
+
+    std::vector<Simplex> simplices;
+    std::vector<Simplex> pieces;
+
+    vtkIdType numCells = chunkEnd - chunkStart;
+    vtkIdType start = chunkStart + numCells * thread / numThreads;
+    vtkIdType end = chunkStart + numCells * (thread + 1) / numThreads;
+
+    for (vtkIdType cellId = start; cellId < end; cellId++) {
+        simplices.clear();
+        reader.GetSimplices(cellId, simplices);
+
+        for (int i = 0; i < (int)simplices.size(); i++) {
+            if (!useBox) {
+                table.AddSimplex(simplices[i]);
+                continue;
+            }
+
+            pieces.clear();
+            box.Clip(simplices[i], pieces);
+
+            for (int j = 0; j < (int)pieces.size(); j++) {
+                if (BoxClipper::ComputeMeasure(pieces[j]) > 0.0) table.AddSimplex(pieces[j]);
+            }
+        }
+    }
+}
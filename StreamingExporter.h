@@ -0,0 +1,77 @@
+/*=========================================================================
+
+  Name:        StreamingExporter.h
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+  Description: Exports cell values straight from the unclipped data,
+               one chunk of cells at a time, so memory use does not
+               grow with the size of the data.
+
+=========================================================================*/
+
+
+#ifndef STREAMINGEXPORTER_H
+#define STREAMINGEXPORTER_H
+
+
+#include "BoxClipper.h"
+#include "CellTable.h"
+
+#include <vtkMultiThreader.h>
+
+#include <string>
+#include <vector>
+
+class vtkDataSet;
+
+
+class StreamingExporter {
+public:
+    StreamingExporter();
+    ~StreamingExporter();
+
+    void SetInput(vtkDataSet* data);
+
+    // Which simplex value to export, and the name of the area/volume column
+    void SetValue(int value);
+    void SetSizeName(const char* name);
+
+    // Clip to a box, with the same parameters as BoxClipper::SetBox().
+    // Without a box, all cells are exported.
+    void SetBox(const double center[3], const double size[3], double rotation, int clipType);
+    void RemoveBox();
+
+    // Write the same rows as CellTable, as text, gzip compressed text for
+    // .gz or a NumPy structured array for .npy.  Each chunk of cells is
+    // triangulated and clipped on all threads and written before the next.
+    // .npz is not supported, as each column must be written whole.
+    bool Write(const char* fileName);
+
+protected:
+    vtkDataSet* input;
+    int value;
+    std::string sizeName;
+
+    bool useBox;
+    BoxClipper clipper;
+
+    // Current chunk of cells, and the rows for each thread
+    vtkIdType chunkStart;
+    vtkIdType chunkEnd;
+    std::vector<CellTable> threadTables;
+
+    static VTK_THREAD_RETURN_TYPE ThreadFunction(void* arg);
+    void ThreadExecute(int thread, int numThreads);
+};
+
+
+#endif
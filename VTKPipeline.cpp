@@ -21,13 +21,12 @@
 
 #include <vtkActor.h>
 #include <vtkActor2D.h>
+#include <vtkActor2DCollection.h>
 #include <vtkAlgorithmOutput.h>
 #include <vtkArrayCalculator.h>
 #include <vtkAssignAttribute.h>
 #include <vtkBox.h>
 #include <vtkCamera.h>
-#include <vtkCell.h>
-#include <vtkCellData.h>
 #include <vtkClipDataSet.h>
 #include <vtkColorTransferFunction.h>
 #include <vtkContourFilter.h>
@@ -37,19 +36,19 @@
 #include <vtkDataArray.h>
 #include <vtkDataSetAttributes.h>
 #include <vtkDataSetMapper.h>
-#include <vtkDataSetSurfaceFilter.h>
 #include <vtkDataSetTriangleFilter.h>
 #include <vtkDiskSource.h>
 #include <vtkDoubleArray.h>
 #include <vtkExtractGeometry.h>
+#include <vtkGraphicsFactory.h>
+#include <vtkImageData.h>
 #include <vtkLinearExtrusionFilter.h>
 #include <vtkMath.h>
 #include <vtkPlane.h>
 #include <vtkPlaneSource.h>
-#include <vtkPNGWriter.h>
 #include <vtkPointData.h>
-#include <vtkPointDataToCellData.h>
 #include <vtkPoints.h>
+#include <vtkPolyData.h>
 #include <vtkPolyDataMapper.h>
 #include <vtkPolyDataMapper2D.h>
 #include <vtkPolygon.h>
@@ -60,26 +59,109 @@
 #include <vtkRenderer.h>
 #include <vtkScalarBarActor.h>
 #include <vtkSTLReader.h>
-#include <vtkTetra.h>
 #include <vtkTextActor.h>
 #include <vtkTextProperty.h>
+#include <vtkTexture.h>
+#include <vtkTimerLog.h>
+#include <vtkToolkits.h>
 #include <vtkTransform.h>
+#include <vtkTransformPolyDataFilter.h>
 #include <vtkTriangleFilter.h>
-#include <vtkTriangle.h>
+#include <vtkUnsignedCharArray.h>
 #include <vtkUnstructuredGrid.h>
 #include <vtkWindowToImageFilter.h>
 #include <vtkXMLPolyDataReader.h>
 #include <vtkXMLUnstructuredGridReader.h>
 
 #include "vtkRendererCallback.h"
-
-#include "MainWindow.h"
+#include "vtkScalarTextureCoordinates.h"
+#include "vtkScaleExtrusion.h"
+#include "vtkTetraSurfaceFilter.h"
+
+#include "BackgroundWriter.h"
+#include "BuildingTiles.h"
+#include "CameraPath.h"
+#include "CellTable.h"
+#include "LODBuilder.h"
+#include "PNGWriter.h"
+#include "ProgressiveStatistics.h"
+#include "RangeCache.h"
+#include "ScalarHistogram.h"
+#include "ScreenshotQueue.h"
+#include "StreamingExporter.h"
+#include "VerticalProfile.h"
+#include "ZonalStatistics.h"
+
+#include "PipelineObserver.h"
 
 #include <fstream>
+#include <string>
+
+#include <stdio.h>
+#include <string.h>
+
+
+// Overlay sizes at the window resolution
+static const double legendWidth = 0.5;
+static const double legendHeight = 0.1;
+static const double legendBorder = 0.0025;
+static const double colorWheelRadius = 30.0;
+static const double colorWheelBorder = 1.5;
+static const int labelFontSize = 16;
+
+// Data with more cells than this is decimated to it while interacting
+static const vtkIdType lodNumberOfCells = 200000;
+
+// Seconds between camera widget and label updates while interacting
+static const double cameraUpdateInterval = 0.1;
+
+// Entries in the color map texture
+static const int colorTableSize = 4096;
+
+// Percentiles for the percentile color map range
+static const double lowPercentile = 0.01;
+static const double highPercentile = 0.99;
+
+// Steps for equalizing the color map, and arrays to keep histograms for
+static const int equalizationSteps = 64;
+static const int maxHistograms = 3;
+
 
+// Position of a 2D actor coordinate, so it can be restored after tiling
+struct OverlayPosition {
+    vtkCoordinate* coordinate;
+    int system;
+    double value[3];
+    vtkCoordinate* reference;
+    double display[2];
+};
 
-VTKPipeline::VTKPipeline(vtkRenderWindowInteractor* rwi, MainWindow* qtWindow) 
-: interactor(rwi), mainWindow(qtWindow) {
+
+VTKPipeline::VTKPipeline(vtkRenderWindowInteractor* rwi, PipelineObserver* pipelineObserver) 
+: observer(pipelineObserver), interactor(rwi) {
+    renderWindow = interactor->GetRenderWindow();
+    ownsRenderWindow = false;
+
+    Initialize();
+}
+
+VTKPipeline::VTKPipeline(int width, int height) 
+: observer(NULL), interactor(NULL) {
+#ifdef VTK_OPENGL_HAS_OSMESA
+    // Render in software, so no display or GPU is needed
+    vtkGraphicsFactory::SetOffScreenOnlyMode(1);
+    vtkGraphicsFactory::SetUseMesaClasses(1);
+#endif
+
+    renderWindow = vtkRenderWindow::New();
+    renderWindow->OffScreenRenderingOn();
+    renderWindow->SetSize(width, height);
+    ownsRenderWindow = true;
+
+    Initialize();
+}
+
+void VTKPipeline::Initialize() {
     // Clipping transform
     clippingBoxTransform = vtkTransform::New();
 
@@ -261,55 +343,89 @@ VTKPipeline::VTKPipeline(vtkRenderWindowInteractor* rwi, MainWindow* qtWindow)
     contourMapper->Delete();
 
 
-    // Need cell data for calculating statistics
-    dataCellData = vtkPointDataToCellData::New();
-    dataCellData->SetInputConnection(dataTriangle->GetOutputPort());
-    dataCellData->PassPointDataOff();
-
     dataColor = vtkColorTransferFunction::New();
 
+    colorMap = new ColorMap();
+    selectedColorMaps[ColorMap::Sequential] = ColorMap::GetDefault(ColorMap::Sequential);
+    selectedColorMaps[ColorMap::Circular] = ColorMap::GetDefault(ColorMap::Circular);
+    selectedColorMaps[ColorMap::Diverging] = ColorMap::GetDefault(ColorMap::Diverging);
+    colorMapRange[0] = 0.0;
+    colorMapRange[1] = 1.0;
+    colorMapRangeMode = FullRange;
+
+    ranges = new RangeCache();
+
+    // The color map is sampled into a 1D texture, so changing it only updates the texture
+    dataColorTable = vtkImageData::New();
+    dataColorTable->SetDimensions(colorTableSize, 1, 1);
+    dataColorTable->SetScalarTypeToUnsignedChar();
+    dataColorTable->SetNumberOfScalarComponents(3);
+    dataColorTable->AllocateScalars();
+
+    dataColorTexture = vtkTexture::New();
+    dataColorTexture->SetInput(dataColorTable);
+    dataColorTexture->MapColorScalarsThroughLookupTableOff();
+    dataColorTexture->InterpolateOn();
+    dataColorTexture->RepeatOff();
+    dataColorTexture->EdgeClampOn();
+
 
     // Below is for rendering
 
 
-    // Make some poly data
-    dataSurface = vtkDataSetSurfaceFilter::New();
+    // Make some poly data, extracting the boundary of the tetrahedra in parallel
+    dataSurface = vtkTetraSurfaceFilter::New();
     dataSurface->SetInputConnection(dataTriangle->GetOutputPort());
     dataSurface->ReleaseDataFlagOn();
 
+    // Texture coordinates over the data range, for the color map texture
+    dataTextureCoordinates = vtkScalarTextureCoordinates::New();
+    dataTextureCoordinates->SetInputConnection(dataSurface->GetOutputPort());
+    dataTextureCoordinates->ReleaseDataFlagOn();
+
 
     // For extruding roofs
     roofOffsetExtrusion = vtkLinearExtrusionFilter::New();
-    roofOffsetExtrusion->SetInputConnection(dataSurface->GetOutputPort());
+    roofOffsetExtrusion->SetInputConnection(dataTextureCoordinates->GetOutputPort());
     roofOffsetExtrusion->SetExtrusionTypeToVectorExtrusion();
     roofOffsetExtrusion->SetVector(0.0, 0.0, -1.0);
     roofOffsetExtrusion->CappingOn();
     roofOffsetExtrusion->SetScaleFactor(1.0);
-    roofOffsetExtrusion->ReleaseDataFlagOn();
+
+    // Extrude to unit thickness once, and change thickness by moving the extruded points
+    roofOffsetThickness = vtkScaleExtrusion::New();
+    roofOffsetThickness->SetInputConnection(roofOffsetExtrusion->GetOutputPort());
+    roofOffsetThickness->SetScaleFactor(1.0);
+    roofOffsetThickness->ReleaseDataFlagOn();
 
 
     // Rendering
     dataMapper = vtkDataSetMapper::New();
     // Call SetInputConnection() when loading/switching between RoofOffset and Mesh
-    dataMapper->ScalarVisibilityOn();
-    dataMapper->SetLookupTable(dataColor);
-    dataMapper->UseLookupTableScalarRangeOn();
+    dataMapper->ScalarVisibilityOff();
     dataMapper->ReleaseDataFlagOn();
 
     dataActor = vtkActor::New();
     dataActor->SetMapper(dataMapper);
+    dataActor->SetTexture(dataColorTexture);
     dataActor->GetProperty()->LightingOff();
 
+    // Decimated data, swapped in while interacting
+    dataLOD = new LODBuilder();
+    dataLOD->SetTargetNumberOfCells(lodNumberOfCells);
+
+    dataLODMapper = vtkPolyDataMapper::New();
+    dataLODMapper->SetInput(dataLOD->GetOutput());
+    dataLODMapper->ScalarVisibilityOff();
+
 
     // Color map legend
-    double width = 0.5;
-    double height = 0.1;
     legend = vtkScalarBarActor::New();
     legend->SetLookupTable(dataColor);
     legend->SetOrientationToHorizontal();
-    legend->SetPosition((1.0 - width) * 0.5, 0.9);
-    legend->SetWidth(width);
-    legend->SetHeight(height);
+    legend->SetPosition((1.0 - legendWidth) * 0.5, 0.9);
+    legend->SetWidth(legendWidth);
+    legend->SetHeight(legendHeight);
     legend->SetLabelFormat("%g");
     legend->SetTitle("XY Velocity Magnitude (m/s)");
     legend->SetMaximumNumberOfColors(256);
@@ -317,21 +433,20 @@ VTKPipeline::VTKPipeline(vtkRenderWindowInteractor* rwi, MainWindow* qtWindow)
     // Border
     // XXX: This is a hack, and probably only looks right on my laptop, 
     // which was necessary for making some images for Vis Viewpoints...
-    double b = 0.0025;
+    double b = legendBorder;
     vtkCoordinate* coord = vtkCoordinate::New();
     coord->SetCoordinateSystemToNormalizedViewport();
 
-    vtkPlaneSource* legendBorderPlane = vtkPlaneSource::New();
+    // Kept to resize when tiling
+    legendBorderPlane = vtkPlaneSource::New();
     legendBorderPlane->SetOrigin(0.0, 0.0, 0.0);
-    legendBorderPlane->SetPoint1(0.0, height * 0.47, 0.0);
-    legendBorderPlane->SetPoint2(width + 2.0 * b, 0.0, 0.0);
+    legendBorderPlane->SetPoint1(0.0, legendHeight * 0.47, 0.0);
+    legendBorderPlane->SetPoint2(legendWidth + 2.0 * b, 0.0, 0.0);
     
     vtkPolyDataMapper2D* legendBorderMapper = vtkPolyDataMapper2D::New();
     legendBorderMapper->SetInputConnection(legendBorderPlane->GetOutputPort());
     legendBorderMapper->SetTransformCoordinate(coord);
 
-    legendBorderPlane->Delete();
-
     legendBorderActor = vtkActor2D::New();
     legendBorderActor->GetPositionCoordinate()->SetCoordinateSystemToNormalizedViewport();
     legendBorderActor->GetPosition2Coordinate()->SetCoordinateSystemToNormalizedViewport();
@@ -352,37 +467,57 @@ VTKPipeline::VTKPipeline(vtkRenderWindowInteractor* rwi, MainWindow* qtWindow)
     CreateLabels();
 
 
-    // Building
-    buildingReader = vtkSTLReader::New();
-
-    vtkDataSetMapper* buildingMapper = vtkDataSetMapper::New();
-    buildingMapper->SetInputConnection(buildingReader->GetOutputPort());
-    buildingMapper->ReleaseDataFlagOn();
-
-    buildingActor = vtkActor::New();
-    buildingActor->SetMapper(buildingMapper);
-    buildingActor->GetProperty()->SetColor(0.5, 0.5, 0.5);
-
-    buildingMapper->Delete();
-
-
     // Renderer
     renderer = vtkRenderer::New();
 renderer->SetBackground(0.5, 0.5, 0.5);
 
     // Don't add actors yet!!!
 
-    interactor->GetRenderWindow()->AddRenderer(renderer);
+    renderWindow->AddRenderer(renderer);
+
+
+    // Building.  Split into tiles when read, which add themselves to the renderer.
+    buildingReader = vtkSTLReader::New();
+
+    buildingTiles = new BuildingTiles(renderer);
 
 
     // Renderer callback
     rendererCallback = vtkRendererCallback::New();
     rendererCallback->SetVTKPipeline(this);
     renderer->AddObserver(vtkCommand::StartEvent, rendererCallback);
+
+    // Camera view last sent to the GUI
+    for (int i = 0; i < 9; i++) cameraView[i] = 0.0;
+    cameraUpdateTime = 0.0;
+    cameraLabelChanged = true;
+    cameraWidgetsChanged = true;
+    cameraUpdateCost = 0.0;
+
+    // Frame rate to aim for while interacting, used to choose the data detail
+    if (interactor) interactor->SetDesiredUpdateRate(30.0);
+
+
+    // Statistics of the current clip
+    statistics = new ProgressiveStatistics();
+    progressiveStatistics = true;
+
+    // Vertical profile
+    profile = new VerticalProfile();
+
+    // Background writer
+    clipWriter = new BackgroundWriter();
+
+    // Screenshot queue
+    screenshotQueue = new ScreenshotQueue();
 }
 
 VTKPipeline::~VTKPipeline() {
+    // Removes the tile actors from the renderer
+    delete buildingTiles;
+
     renderer->Delete();
+    if (ownsRenderWindow) renderWindow->Delete();
     rendererCallback->Delete();
 
     clippingBoxTransform->Delete();
@@ -401,22 +536,34 @@ VTKPipeline::~VTKPipeline() {
 
     roofOffsetReader->Delete();
     roofOffsetExtrusion->Delete();
+    roofOffsetThickness->Delete();
 
     meshReader->Delete();
 
     dataAttribute->Delete();
     dataTriangle->Delete();
     dataSurface->Delete();
-    dataCellData->Delete();
+    dataTextureCoordinates->Delete();
     dataColor->Delete();
+    delete colorMap;
+    delete ranges;
+    for (int i = 0; i < (int)histograms.size(); i++) {
+        delete histograms[i];
+    }
+    dataColorTable->Delete();
+    dataColorTexture->Delete();
     dataMapper->Delete();
     dataActor->Delete();
+    dataLODMapper->Delete();
+    delete dataLOD;
     contourActor->Delete();
 
     legend->Delete();
     legendBorderActor->Delete();
+    legendBorderPlane->Delete();
     colorWheelActor->Delete();
     colorWheelBorderActor->Delete();
+    colorWheelScale->Delete();
     statisticsLabel->Delete();
     volumeLabel->Delete();
     fileNameLabel->Delete();
@@ -424,7 +571,11 @@ VTKPipeline::~VTKPipeline() {
     cameraLabel->Delete();
 
     buildingReader->Delete();
-    buildingActor->Delete();
+
+    delete statistics;
+    delete profile;
+    delete clipWriter;
+    delete screenshotQueue;
 }
 
 
@@ -484,9 +635,13 @@ void VTKPipeline::OpenBuildingFile(const char* fileName) {
 
     // Read the data
     buildingReader->SetFileName(fileName);
+    buildingReader->Update();
+
+    // Tile the buildings, which adds the tile actors, and free the full copy
+    buildingTiles->SetInput(buildingReader->GetOutput());
+    buildingReader->GetOutput()->ReleaseData();
     
     // Add the actors
-    renderer->AddViewProp(buildingActor);
     renderer->AddViewProp(cameraLabel);
 
     // Render
@@ -495,96 +650,308 @@ void VTKPipeline::OpenBuildingFile(const char* fileName) {
 
 void VTKPipeline::SaveData(const char* fileName) {
     // Make sure data is up-to-date
-    dataCellData->Update();
     dataTriangle->Update();
 
-    vtkDataSet* data = dataCellData->GetOutput();
-    vtkDataArray* cd = data->GetCellData()->GetScalars();
+    // Save the cell data, along with the area/volume and center of each cell.
+    // The format is chosen from the file extension.
+    std::string name = fileName;
+    if (name.size() >= 4 && name.substr(name.size() - 4) == ".npz") {
+        // Each column is stored whole, so build the table in memory
+        CellTable table;
+        table.Compute(dataTriangle->GetOutput(), GetSimplexValue(), GetSizeName(true));
+        table.Write(fileName);
 
-    if (data == NULL || cd == NULL) return;
+        return;
+    }
 
-    // Open the file for writing
-    std::ofstream file;
-    file.open(fileName);
+    // Write the rows straight from the clip, a chunk of cells at a time
+    StreamingExporter exporter;
+    exporter.SetInput(dataTriangle->GetOutput());
+    exporter.SetValue(GetSimplexValue());
+    exporter.SetSizeName(GetSizeName(true));
+    exporter.Write(fileName);
+}
 
-    if (!file.good()) {
-        std::cout << "Could not open " << fileName << " for writing" << std::endl;
+void VTKPipeline::StreamData(const char* fileName, bool clip) {
+    // Make sure data is up-to-date
+    dataAttribute->Update();
+
+    // Read straight from the unclipped data, a chunk of cells at a time
+    StreamingExporter exporter;
+    exporter.SetInput(vtkDataSet::SafeDownCast(dataAttribute->GetOutput()));
+    exporter.SetValue(GetSimplexValue());
+    exporter.SetSizeName(GetSizeName(clip));
+
+    if (clip) {
+        double center[3];
+        double size[3];
+        GetClippingBoxCenter(center);
+        GetClippingBoxSize(size);
+
+        exporter.SetBox(center, size, GetClippingBoxRotation(), clipType);
     }
 
-    // Write header
-    std::string av;
-    if (dataSet == RoofOffset || clipType == CutX || clipType == CutY || clipType == CutZ) {
-        av = "Area";
+    exporter.Write(fileName);
+}
+
+void VTKPipeline::SaveClip(const char* fileName, bool compress) {
+    std::string name = fileName;
+    bool vtp = name.size() >= 4 && name.substr(name.size() - 4) == ".vtp";
+
+    // Make sure data is up-to-date
+    vtkDataSet* data;
+    if (vtp) {
+        dataSurface->Update();
+        data = dataSurface->GetOutput();
     }
     else {
-        av = "Volume";
+        dataTriangle->Update();
+        data = dataTriangle->GetOutput();
     }
-    file << "Value, " << av << ", X, Y, Z" << std::endl;
 
-    // Save the cell data, along with the area/volume of each cell
-    for (int i = 0; i < cd->GetNumberOfTuples(); i++) {
-        vtkCell* cell = data->GetCell(i);
+    // Add the colors as shown, for viewers without the color map
+    vtkDataSet* copy = data->NewInstance();
+    copy->ShallowCopy(data);
 
-        vtkPoints* p;
-        double cellSize = 0.0;
-        double p0[3], p1[3], p2[3], p3[3];
-        double center[3];
+    vtkDataArray* scalars = data->GetPointData()->GetScalars();
+    if (scalars) {
+        vtkUnsignedCharArray* colors = colorMap->MapScalars(scalars);
+        copy->GetPointData()->AddArray(colors);
+        colors->Delete();
+    }
 
-        switch (cell->GetCellType()) {
-            case VTK_TRIANGLE:
-                p = cell->GetPoints();
-                
-                p->GetPoint(0, p0);
-                p->GetPoint(1, p1);
-                p->GetPoint(2, p2);
+    // The writer copies the data, so the pipeline can change while writing
+    clipWriter->Start(copy, fileName, compress);
 
-                cellSize = vtkTriangle::SafeDownCast(cell)->ComputeArea();
+    copy->Delete();
+}
 
-                vtkTriangle::TriangleCenter(p0, p1, p2, center);
+void VTKPipeline::FinishClip() {
+    clipWriter->Finish();
+}
 
-                break;
+void VTKPipeline::UpdateBackground() {
+    clipWriter->Poll();
 
-            case VTK_TETRA:
-                p = cell->GetPoints();
-                
-                p->GetPoint(0, p0);
-                p->GetPoint(1, p1);
-                p->GetPoint(2, p2);
-                p->GetPoint(3, p3);
+    if (dataLOD->Poll()) {
+        dataLODMapper->Modified();
+    }
 
-                cellSize = abs(vtkTetra::ComputeVolume(p0, p1, p2, p3));
+    // Rebuild after the data shown changes, e.g. a new clip
+    vtkPolyData* surface = vtkPolyData::SafeDownCast(dataMapper->GetInput());
+    if (dataActor->GetVisibility() && surface && surface->GetNumberOfCells() > lodNumberOfCells) {
+        dataLOD->Update(surface);
+    }
+}
 
-                vtkTetra::TetraCenter(p0, p1, p2, p3, center);
+void VTKPipeline::SaveScreenshot(const char* fileName) {
+    RenderView();
+    renderWindow->Modified();
 
-                break;
+    vtkWindowToImageFilter* image = vtkWindowToImageFilter::New();
+    image->SetInput(renderWindow);
+    image->Update();
 
-            default:
-                // Should never be here, due to the vtkDataSetTriangleFilter
-                std::cout << "Unknown cell type: " << cell->GetCellType() << std::endl;
-        }
+    // Copies the image, so encoding doesn't hold up rendering
+    screenshotQueue->Add(image->GetOutput(), fileName);
 
-        // Write to the file
-        file << cd->GetTuple1(i) << ", " << cellSize << ", " << 
-                center[0] << ", " << center[1] << ", " << center[2] << std::endl;
-    }
+    image->Delete();
+}
 
-    file.close();
+void VTKPipeline::FinishScreenshots() {
+    screenshotQueue->Finish();
 }
 
-void VTKPipeline::SaveScreenshot(const char* fileName) {
-    interactor->Render();
-    interactor->GetRenderWindow()->Modified();
+void VTKPipeline::AddMovieKeyframe(const char* fileName, double time) {
+    double center[3];
+    double size[3];
+    GetClippingBoxCenter(center);
+    GetClippingBoxSize(size);
+
+    CameraPath::Append(fileName, time, renderer->GetActiveCamera(),
+                       center, size, GetClippingBoxRotation(), clipType);
+}
+
+void VTKPipeline::SaveMovie(const char* pathFileName, const char* filePrefix, double frameRate, bool clip) {
+    CameraPath path;
+    if (!path.Read(pathFileName)) return;
+
+    if (frameRate <= 0.0) {
+        std::cout << "Invalid frame rate " << frameRate << std::endl;
+        return;
+    }
+
+    vtkRenderWindow* window = renderWindow;
+    vtkCamera* camera = renderer->GetActiveCamera();
+
+    // Render into the back buffer only
+    window->SwapBuffersOff();
 
     vtkWindowToImageFilter* image = vtkWindowToImageFilter::New();
-    image->SetInput(interactor->GetRenderWindow());
+    image->SetInput(window);
+    image->ReadFrontBufferOff();
+    image->ShouldRerenderOff();
+
+    double start = path.GetStartTime();
+    int numFrames = (int)floor((path.GetEndTime() - start) * frameRate + 0.5) + 1;
+
+    std::vector<char> name(strlen(filePrefix) + 32);
+
+    // Each frame shows the exact statistics of its clip
+    progressiveStatistics = false;
+    FinishStatistics();
+
+    for (int i = 0; i < numFrames; i++) {
+        double t = start + i / frameRate;
+
+        path.InterpolateCamera(t, camera);
+
+        if (clip && path.HasClip()) {
+            double center[3];
+            double size[3];
+            double rotation;
+            int type;
+            path.InterpolateClip(t, center, size, rotation, type);
+
+            SetClippingBoxCenter(center[0], center[1], center[2]);
+            SetClippingBoxSize(size[0], size[1], size[2]);
+            SetClippingBoxRotation(rotation);
+            if (type != clipType) SetClipType((ClipType)type);
+            UpdateClipping();
+        }
+
+        renderer->ResetCameraClippingRange();
+        window->Render();
 
-    vtkPNGWriter* writer = vtkPNGWriter::New();
-    writer->SetInputConnection(image->GetOutputPort());
-    writer->SetFileName(fileName);
-    writer->Write();
+        image->Modified();
+        image->Update();
+
+        // Copies the image, and waits if too many frames are pending
+        sprintf(&name[0], "%s%05d.png", filePrefix, i);
+        screenshotQueue->Add(image->GetOutput(), &name[0]);
+    }
 
     image->Delete();
-    writer->Delete();
+
+    window->SwapBuffersOn();
+
+    progressiveStatistics = true;
+
+    screenshotQueue->Finish();
+
+    RenderView();
+}
+
+void VTKPipeline::SaveLargeScreenshot(const char* fileName, int magnification) {
+    vtkRenderWindow* window = renderWindow;
+
+    int width = window->GetSize()[0];
+    int height = window->GetSize()[1];
+    int m = magnification < 1 ? 1 : magnification;
+
+    PNGWriter writer;
+    if (!writer.Open(fileName, width * m, height * m)) return;
+
+    // Narrow the view so each tile is 1/m of it, keeping the camera position
+    // so the clipping range, and therefore depth, matches across tiles
+    vtkCamera* camera = renderer->GetActiveCamera();
+
+    double viewAngle = camera->GetViewAngle();
+    double parallelScale = camera->GetParallelScale();
+    double windowCenter[2];
+    camera->GetWindowCenter(windowCenter);
+
+    double t = tan(vtkMath::RadiansFromDegrees(viewAngle * 0.5)) / m;
+    camera->SetViewAngle(vtkMath::DegreesFromRadians(atan(t)) * 2.0);
+    camera->SetParallelScale(parallelScale / m);
+
+    // Scale overlays to the image size, then place the 2D actors in
+    // display coordinates of the whole image.  Compute all positions
+    // first, as some coordinates are relative to others.
+    SetOverlayScale(m);
+
+    std::vector<OverlayPosition> overlays;
+
+    vtkActor2DCollection* actors = renderer->GetActors2D();
+    actors->InitTraversal();
+    for (vtkActor2D* actor = actors->GetNextActor2D(); actor; actor = actors->GetNextActor2D()) {
+        vtkCoordinate* coordinates[2] = { actor->GetPositionCoordinate(), actor->GetPosition2Coordinate() };
+
+        for (int i = 0; i < 2; i++) {
+            OverlayPosition p;
+            p.coordinate = coordinates[i];
+            p.system = p.coordinate->GetCoordinateSystem();
+            p.coordinate->GetValue(p.value);
+            p.reference = p.coordinate->GetReferenceCoordinate();
+
+            int* display = p.coordinate->GetComputedDisplayValue(renderer);
+            p.display[0] = display[0] * m;
+            p.display[1] = display[1] * m;
+
+            overlays.push_back(p);
+        }
+    }
+
+    for (int i = 0; i < (int)overlays.size(); i++) {
+        overlays[i].coordinate->SetCoordinateSystemToDisplay();
+        overlays[i].coordinate->SetReferenceCoordinate(NULL);
+    }
+
+    // Render into the back buffer only
+    window->SwapBuffersOff();
+
+    // Each row of tiles is one band of the image, starting from the top
+    std::vector<unsigned char> band((size_t)width * m * height * 3);
+    vtkUnsignedCharArray* pixels = vtkUnsignedCharArray::New();
+
+    bool success = true;
+    for (int y = m - 1; y >= 0 && success; y--) {
+        for (int x = 0; x < m; x++) {
+            camera->SetWindowCenter(windowCenter[0] * m + 2 * x + 1 - m,
+                                    windowCenter[1] * m + 2 * y + 1 - m);
+
+            for (int i = 0; i < (int)overlays.size(); i++) {
+                overlays[i].coordinate->SetValue(overlays[i].display[0] - x * width,
+                                                 overlays[i].display[1] - y * height);
+            }
+
+            window->Render();
+            window->GetPixelData(0, 0, width - 1, height - 1, 0, pixels);
+
+            // Rows are bottom first
+            for (int row = 0; row < height; row++) {
+                memcpy(&band[((size_t)(height - 1 - row) * width * m + (size_t)x * width) * 3],
+                       pixels->GetPointer((vtkIdType)row * width * 3), width * 3);
+            }
+        }
+
+        success = writer.WriteRows(&band[0], height);
+    }
+
+    pixels->Delete();
+
+    // Restore
+    window->SwapBuffersOn();
+
+    for (int i = 0; i < (int)overlays.size(); i++) {
+        overlays[i].coordinate->SetCoordinateSystem(overlays[i].system);
+        overlays[i].coordinate->SetReferenceCoordinate(overlays[i].reference);
+        overlays[i].coordinate->SetValue(overlays[i].value);
+    }
+
+    SetOverlayScale(1.0);
+
+    camera->SetViewAngle(viewAngle);
+    camera->SetParallelScale(parallelScale);
+    camera->SetWindowCenter(windowCenter[0], windowCenter[1]);
+
+    RenderView();
+
+    // Always close the file, and don't leave a truncated image behind
+    if (!writer.Close()) {
+        std::cout << "Error writing " << fileName << std::endl;
+        remove(fileName);
+    }
 }
 
 
@@ -716,6 +1083,36 @@ void VTKPipeline::OpenClipSettings(const char* fileName) {
     renderer->ResetCameraClippingRange();
 }
 
+void VTKPipeline::SaveBatchStatistics(const char* boxFileName, const char* fileName) {
+    ZonalStatistics statistics;
+    if (!statistics.ReadBoxes(boxFileName)) return;
+
+    // Use the full data set, not the current clip
+    dataAttribute->Update();
+
+    statistics.SetInput(vtkDataSet::SafeDownCast(dataAttribute->GetOutput()));
+    statistics.Update();
+    statistics.WriteTable(fileName);
+}
+
+
+void VTKPipeline::ComputeProfile(double binWidth) {
+    // Make sure data is up-to-date
+    dataTriangle->Update();
+
+    profile->SetInput(dataTriangle->GetOutput());
+    profile->SetBinWidth(binWidth);
+    profile->Update();
+}
+
+VerticalProfile* VTKPipeline::GetProfile() {
+    return profile;
+}
+
+void VTKPipeline::SaveProfile(const char* fileName) {
+    profile->WriteTable(fileName);
+}
+
 
 bool VTKPipeline::GetShowData() {
     return dataActor->GetVisibility() == 1;
@@ -736,11 +1133,11 @@ void VTKPipeline::SetDataOpacity(double opacity) {
 
 
 bool VTKPipeline::GetShowBuilding() {
-    return buildingActor->GetVisibility() == 1;
+    return buildingTiles->GetVisibility();
 }
 
 void VTKPipeline::SetShowBuilding(bool show) {
-    buildingActor->SetVisibility(show);
+    buildingTiles->SetVisibility(show);
 }
 
 
@@ -769,7 +1166,7 @@ void VTKPipeline::SetDataSet(VTKPipeline::DataSet which) {
             SetClipType(AccurateClip);
             dataAttribute->SetInputConnection(roofOffsetReader->GetOutputPort());
             dataMapper->ImmediateModeRenderingOff();
-            dataMapper->SetInputConnection(roofOffsetExtrusion->GetOutputPort());
+            dataMapper->SetInputConnection(roofOffsetThickness->GetOutputPort());
             volumeLabel->VisibilityOff();
             fileNameLabel->SetInput(roofOffsetReader->GetFileName());
 
@@ -779,7 +1176,7 @@ void VTKPipeline::SetDataSet(VTKPipeline::DataSet which) {
             SetClipType(CutZ);
             dataAttribute->SetInputConnection(meshReader->GetOutputPort());
             dataMapper->ImmediateModeRenderingOn();
-            dataMapper->SetInputConnection(dataSurface->GetOutputPort());
+            dataMapper->SetInputConnection(dataTextureCoordinates->GetOutputPort());
             volumeLabel->VisibilityOn();
             fileNameLabel->SetInput(meshReader->GetFileName());
 
@@ -787,6 +1184,17 @@ void VTKPipeline::SetDataSet(VTKPipeline::DataSet which) {
     }
     dataAttribute->Update();
 
+    // Compute the ranges of all vector data now, so switching is quick
+    vtkPointData* pointData = vtkDataSet::SafeDownCast(dataAttribute->GetOutput())->GetPointData();
+    const char* arrayNames[3] = { "velocityNormXYMag", "velocityNormXYAngle", "velocityNormZ" };
+    for (int i = 0; i < 3; i++) {
+        vtkDataArray* array = pointData->GetArray(arrayNames[i]);
+        if (array) {
+            double range[2];
+            ranges->GetRange(array, 0, range);
+        }
+    }
+
     // Set the color map
     ResetColorMapRange();
 
@@ -854,13 +1262,13 @@ void VTKPipeline::SetVectorData(VTKPipeline::VectorData which) {
     // Set the color map range
     ResetColorMapRange();
 
-    // Update statistics
-    ComputeStatistics();
+    // Statistics for all vector data are cached with the clip
+    UpdateStatisticsLabel();
 }
 
 
 void VTKPipeline::GetBounds(double bounds[6]) {
-    vtkDataSet::SafeDownCast(dataAttribute->GetOutput())->GetBounds(bounds);
+    ranges->GetBounds(vtkDataSet::SafeDownCast(dataAttribute->GetOutput()), bounds);
 }
 
 
@@ -977,6 +1385,10 @@ void VTKPipeline::UpdateClipping() {
                                     -clippingBoxActor->GetPosition()[2]);
 
     ComputeStatistics();
+
+    // The profile was of the previous clip
+    profile->SetInput(NULL);
+    profile->Update();
 }
 
 
@@ -1005,47 +1417,116 @@ void VTKPipeline::ResetClippingBox() {
 
 
 int VTKPipeline::GetRoofOffsetThickness() {
-    return roofOffsetExtrusion->GetScaleFactor();
+    return (int)roofOffsetThickness->GetScaleFactor();
 }
 
 void VTKPipeline::SetRoofOffsetThickness(int thickness) {
-    roofOffsetExtrusion->SetScaleFactor(thickness);
+    roofOffsetThickness->SetScaleFactor(thickness);
 }
 
 
 void VTKPipeline::GetDataRange(double range[2]) {
-    vtkDataSet::SafeDownCast(dataAttribute->GetOutput())->GetScalarRange(range);
+    vtkDataArray* scalars = vtkDataSet::SafeDownCast(dataAttribute->GetOutput())->GetPointData()->GetScalars();
+    if (!scalars) {
+        range[0] = 0.0;
+        range[1] = 1.0;
+        return;
+    }
+
+    ranges->GetRange(scalars, 0, range);
+}
+
+void VTKPipeline::GetColorMapRange(double range[2]) {
+    range[0] = colorMapRange[0];
+    range[1] = colorMapRange[1];
 }
 
 void VTKPipeline::SetColorMapRange(double min, double max) {
-    switch (vectorData) {
-        case XYMagnitude:
-            // Create a black-body radiation color map
-            CreateBlackBody(min, max);
-            break;
+    colorMapRange[0] = min;
+    colorMapRange[1] = max;
+
+    // Use the color map selected for this kind of data
+    colorMap->SetColorMap(selectedColorMaps[GetColorMapKind()]);
+    colorMap->SetRange(min, max);
+
+    // Place the color map at evenly spaced quantiles within the range
+    std::vector<double> equalization;
+    ScalarHistogram* histogram = colorMapRangeMode == EqualizedRange &&
+                                 GetColorMapKind() == ColorMap::Sequential ? GetHistogram() : NULL;
+    if (histogram && max > min) {
+        double f0 = histogram->GetFraction(min);
+        double f1 = histogram->GetFraction(max);
+
+        equalization.push_back(min);
+        for (int i = 1; i < equalizationSteps; i++) {
+            double v = histogram->GetValue(f0 + (f1 - f0) * i / equalizationSteps);
+            v = v < equalization.back() ? equalization.back() : v > max ? max : v;
+            equalization.push_back(v);
+        }
+        equalization.push_back(max);
+    }
+    colorMap->SetEqualization(equalization);
+
+    // The transfer function is still used for the legend and color wheel
+    colorMap->Apply(dataColor);
+    legend->SetNumberOfLabels(colorMap->GetNumberOfLabels());
+
+    // Spread the texture over the color map range, so a narrow range still
+    // uses all of the texels.  Values outside it get the end texels.
+    dataTextureCoordinates->SetRange(min, max);
 
+    UpdateColorTable();
+}
+
+
+ColorMap::Kind VTKPipeline::GetColorMapKind() {
+    switch (vectorData) {
         case XYAngle:
-            // Create a circular color map
-            CreateCircular();
-            break;
+            return ColorMap::Circular;
 
         case ZComponent:
-            // If positive and negative values, use a double-ended color map, 
-            // otherwise use a black-body radiation color map
-            if (min < 0.0 && max > 0.0) {
-                CreateDoubleEnded(min, max);
+            // If positive and negative values, use a double-ended color map
+            if (colorMapRange[0] < 0.0 && colorMapRange[1] > 0.0) {
+                return ColorMap::Diverging;
             }
-            else {
-                CreateBlackBody(min, max);
-            }
-            break;
-        }
+            return ColorMap::Sequential;
+
+        default:
+            return ColorMap::Sequential;
+    }
+}
+
+int VTKPipeline::GetColorMap() {
+    return colorMap->GetColorMap();
+}
+
+VTKPipeline::ColorMapRangeMode VTKPipeline::GetColorMapRangeMode() {
+    return colorMapRangeMode;
+}
+
+void VTKPipeline::SetColorMapRangeMode(ColorMapRangeMode mode) {
+    colorMapRangeMode = mode;
+
+    ResetColorMapRange();
+}
+
+void VTKPipeline::SetColorMap(int map) {
+    // Remember the choice for this kind of data
+    selectedColorMaps[ColorMap::GetKind(map)] = map;
+
+    SetColorMapRange(colorMapRange[0], colorMapRange[1]);
 }
 
 
 void VTKPipeline::Render() {
     renderer->ResetCameraClippingRange();
-    interactor->Render();
+    RenderView();
+}
+
+void VTKPipeline::RenderView() {
+    // Go through the interactor when there is one, so the GUI controls drawing
+    if (interactor) interactor->Render();
+    else renderWindow->Render();
 }
 
 
@@ -1080,6 +1561,11 @@ void VTKPipeline::SetShowClippingBoxLabel(bool show) {
 
 void VTKPipeline::SetShowCameraLabel(bool show) {
     cameraLabel->SetVisibility(show);
+
+    if (show && cameraLabelChanged) {
+        UpdateCameraLabel();
+        cameraLabelChanged = false;
+    }
 }
 
 void VTKPipeline::SetShowDataStatisticsLabel(bool show) {
@@ -1099,7 +1585,6 @@ void VTKPipeline::SetCameraPosition(double x, double y, double z, double d) {
     c->SetDistance(d);
 
     renderer->ResetCameraClippingRange();
-    interactor->Render();
 }
 
 void VTKPipeline::SetCameraRotation(double w, double x, double y, double z) {
@@ -1125,7 +1610,6 @@ void VTKPipeline::SetCameraRotation(double w, double x, double y, double z) {
     c->SetDistance(d);
 
     renderer->ResetCameraClippingRange();
-    interactor->Render();
 }
 
 
@@ -1136,7 +1620,6 @@ void VTKPipeline::ResetCameraX() {
     c->SetViewUp(0.0, 0.0, 1.0);
     c->Azimuth(-GetClippingBoxRotation());
     renderer->ResetCamera();
-    interactor->Render();
 }
 
 void VTKPipeline::ResetCameraY() {    
@@ -1146,7 +1629,6 @@ void VTKPipeline::ResetCameraY() {
     c->SetViewUp(0.0, 0.0, 1.0);
     c->Azimuth(-GetClippingBoxRotation());
     renderer->ResetCamera();
-    interactor->Render();
 }
 
 void VTKPipeline::ResetCameraZ() {    
@@ -1156,361 +1638,218 @@ void VTKPipeline::ResetCameraZ() {
     c->SetViewUp(0.0, 1.0, 0.0);
     c->Roll(GetClippingBoxRotation());
     renderer->ResetCamera();
-    interactor->Render();
 }
 
 
 void VTKPipeline::UpdateCamera() {
-    UpdateCameraLabel();
+    double start = vtkTimerLog::GetUniversalTime();
 
     vtkCamera* c = renderer->GetActiveCamera();
 
-    double* p = c->GetPosition();
-    double* o = c->GetOrientationWXYZ();
-    double d = c->GetDistance();
-
-    mainWindow->SetCameraPosition(p[0], p[1], p[2], d);
-    mainWindow->SetCameraRotation(o[0], o[1], o[2], o[3]);
-}
-
-
-void VTKPipeline::ComputeStatistics() {
-    // Make sure data is up-to-date
-    dataCellData->Update();
-    dataTriangle->Update();
-
-    vtkDataSet* data = dataCellData->GetOutput();
-    vtkDataArray* pd = dataTriangle->GetOutput()->GetPointData()->GetScalars();
-    vtkDataArray* cd = data->GetCellData()->GetScalars();
-    vtkDataArray* cv = data->GetCellData()->GetVectors();
-
-    if (data == NULL || pd == NULL || cd == NULL || cv == NULL) return;
+    // Check the view itself, as the camera is modified by every clipping range reset
+    double view[9];
+    c->GetPosition(view);
+    c->GetFocalPoint(view + 3);
+    c->GetViewUp(view + 6);
+
+    bool changed = false;
+    for (int i = 0; i < 9; i++) {
+        if (view[i] != cameraView[i]) {
+            changed = true;
+            cameraView[i] = view[i];
+        }
+    }
 
-    // Get the min and max from point data
-    double min = pd->GetNumberOfTuples() > 0 ? pd->GetTuple1(0) : 0.0;
-    double max = min;
-    for (int i = 1; i < pd->GetNumberOfTuples(); i++) {
-        double v = pd->GetTuple1(i);
-        min = v < min ? v : min;
-        max = v > max ? v : max;
+    if (changed) {
+        cameraLabelChanged = true;
+        cameraWidgetsChanged = true;
     }
 
-    // Compute the mean from cell data, accounting for the area/volume of each cell
-    // Need to account for angles, since the average of 1 degree and 359 degrees should be 0 (or 360)
-    // Do this by using the 2D vector components
-    double sum = 0.0;
-    double xSum = 0.0;
-    double ySum = 0.0;
-    double size = 0.0;
-    for (int i = 0; i < cd->GetNumberOfTuples(); i++) {
-        vtkCell* cell = data->GetCell(i);
-
-        vtkPoints* p;
-        double cellSize = 0.0;
-        double p0[3], p1[3], p2[3], p3[3];
-
-        switch (cell->GetCellType()) {
-            case VTK_TRIANGLE:
-                cellSize = vtkTriangle::SafeDownCast(cell)->ComputeArea();                    
-
-                break;
-
-            case VTK_TETRA:
-                p = cell->GetPoints();
-                
-                p->GetPoint(0, p0);
-                p->GetPoint(1, p1);
-                p->GetPoint(2, p2);
-                p->GetPoint(3, p3);
-
-                cellSize = abs(vtkTetra::ComputeVolume(p0, p1, p2, p3));
-
-                break;
-
-            default:
-                // Should never be here, due to the vtkDataSetTriangleFilter
-                std::cout << "Unknown cell type: " << cell->GetCellType() << std::endl;
-        }
+    // While moving, update at a fixed rate rather than every frame.  The
+    // still render on release brings everything up to date.
+    bool due = !IsInteracting() || start - cameraUpdateTime >= cameraUpdateInterval;
 
-        if (vectorData == XYAngle) {
-            xSum += cv->GetTuple3(i)[0] * cellSize;
-            ySum += cv->GetTuple3(i)[1] * cellSize;
+    if (due && (cameraLabelChanged || cameraWidgetsChanged)) {
+        // The label is regenerated when shown
+        if (cameraLabel->GetVisibility()) {
+            UpdateCameraLabel();
+            cameraLabelChanged = false;
         }
-        else {
-            sum += cd->GetTuple1(i) * cellSize;
-        }
-        size += cellSize;
-    }
-
-    double mean;
-    if (vectorData == XYAngle) {
-        double xMean = xSum / size;
-        double yMean = ySum / size;
 
-        // Calculate the angle of this vector from 0 to 360 degrees, with positive Y as 0 degrees
-        // We want the *incoming* wind angle, which is the direction of the negative wind vector
-        double ySign = yMean < 0 ? -1.0 : 1.0;
-        mean = -(vtkMath::DegreesFromRadians(acos(-xMean)) * -ySign - 90.0);
-        mean = mean < 0.0 ? mean + 360.0 : mean;
-    }
-    else {
-        mean = sum / size;
-    }
+        if (cameraWidgetsChanged) {
+            double* p = c->GetPosition();
+            double* o = c->GetOrientationWXYZ();
+            double d = c->GetDistance();
 
-    // Set the statistics label
-    UpdateStatisticsLabel(min, max, mean);
+            if (observer) observer->CameraChanged(p, d, o);
 
-    // Set the volume label
-    UpdateVolumeLabel(size);
-}
+            cameraWidgetsChanged = false;
+        }
 
+        cameraUpdateTime = start;
+    }
 
-void VTKPipeline::UpdatePipeline() {
-    dataMapper->Update();
+    // Smoothed cost per frame
+    double cost = vtkTimerLog::GetUniversalTime() - start;
+    cameraUpdateCost = cameraUpdateCost * 0.9 + cost * 0.1;
 }
 
-
-void VTKPipeline::ResetColorMapRange() {
-    double dataRange[2];
-    vtkDataSet::SafeDownCast(dataAttribute->GetOutput())->GetScalarRange(dataRange);
-    SetColorMapRange(dataRange[0], dataRange[1]);
+double VTKPipeline::GetCameraUpdateCost() {
+    return cameraUpdateCost;
 }
 
 
-void VTKPipeline::CreateBlackBody(double min, double max) {
-    // Create a black-body radiation color map
-    dataColor->RemoveAllPoints();
-
-    // Normal
-/*
-    dataColor->AddRGBPoint(min,                           0.0, 0.0, 0.0);
-    dataColor->AddRGBPoint(min + (max - min) / 3.0,       1.0, 0.0, 0.0);
-    dataColor->AddRGBPoint(min + (max - min) * 2.0 / 3.0, 1.0, 1.0, 0.0);
-    dataColor->AddRGBPoint(max,                           1.0, 1.0, 1.0);
-*/
-
-    // Cool
-/*
-    dataColor->AddRGBPoint(min,                           0.0, 0.0, 0.0);
-    dataColor->AddRGBPoint(min + (max - min) / 3.0,       0.0, 0.0, 1.0);
-    dataColor->AddRGBPoint(min + (max - min) * 2.0 / 3.0, 0.0, 1.0, 1.0);
-    dataColor->AddRGBPoint(max,                           1.0, 1.0, 1.0);
-*/
-
+void VTKPipeline::UpdateDataDetail() {
+    // Only use the decimated data if it is from the data being shown
+    vtkPolyData* surface = vtkPolyData::SafeDownCast(dataMapper->GetInput());
+    bool decimated = IsInteracting() && surface && dataLOD->IsCurrent(surface);
 
-    // Normal plus some hues
-/*
-    dataColor->AddRGBPoint(min,                             0.0, 0.0, 0.25);
-    dataColor->AddRGBPoint(min + (max - min) * 1.0 / 5.0,   0.0, 0.25, 0.0);
-    dataColor->AddRGBPoint(min + (max - min) * 2.0 / 5.0,   0.5, 0.0, 0.0);
-    dataColor->AddRGBPoint(min + (max - min) * 3.0 / 5.0,   0.75, 0.75, 0.0);
-    dataColor->AddRGBPoint(min + (max - min) * 4.0 / 5.0,   0.0, 1.0, 1.0);
-    dataColor->AddRGBPoint(max,                             1.0, 1.0, 1.0);
-*/
-
-
-    // Banded with luminance gradient
-    double step = 0.001;
-
-    // Purple
-    dataColor->AddRGBPoint(min,                                     0.0625, 0.0, 0.25);
-    dataColor->AddRGBPoint(min + (max - min) * 1.0 / 5.0,           0.25, 0.0, 1.0);
-
-    // Red
-    dataColor->AddRGBPoint(min + (max - min) * 1.0 / 5.0 + step,    0.25, 0.0, 0.0);
-    dataColor->AddRGBPoint(min + (max - min) * 2.0 / 5.0,           1.0, 0.0, 0.0);
-
-    // Orange
-    dataColor->AddRGBPoint(min + (max - min) * 2.0 / 5.0 + step,    0.25, 0.125, 0.0);
-    dataColor->AddRGBPoint(min + (max - min) * 3.0 / 5.0,           1.0, 0.5, 0.0);
-
-    // Yellow
-    dataColor->AddRGBPoint(min + (max - min) * 3.0 / 5.0 + step,    0.25, 0.25, 0.0);
-    dataColor->AddRGBPoint(min + (max - min) * 4.0 / 5.0,           1.0, 1.0, 0.0);
-
-    // White
-    dataColor->AddRGBPoint(min + (max - min) * 4.0 / 5.0 + step,    0.25, 0.25, 0.25);
-    dataColor->AddRGBPoint(max,                                     1.0, 1.0, 1.0);
+    vtkMapper* mapper = decimated ? (vtkMapper*)dataLODMapper : (vtkMapper*)dataMapper;
+    if (dataActor->GetMapper() != mapper) {
+        dataActor->SetMapper(mapper);
+    }
 
-    
-    // Set an appropriate number of labels for the legend
-    legend->SetNumberOfLabels(6);
+    // Simplified buildings for tiles far from the camera
+    buildingTiles->UpdateDetail(renderer->GetActiveCamera());
 }
 
-void VTKPipeline::CreateCircular() {
-    // Create a circular color map
-    dataColor->RemoveAllPoints();
-
-    // Wrapped double-ended
-    dataColor->AddRGBPoint(0.0,         1.0, 1.0, 1.0);
-    dataColor->AddRGBPoint(45.0,        0.0, 1.0, 1.0);
-    dataColor->AddRGBPoint(90.0,        0.0, 0.5, 0.0);
-    dataColor->AddRGBPoint(135.0,       0.0, 0.0, 0.5);
-    dataColor->AddRGBPoint(180.0,       0.25, 0.0, 0.25);
-    dataColor->AddRGBPoint(225.0,       0.5, 0.0, 0.0);
-    dataColor->AddRGBPoint(270.0,       1.0, 0.5, 0.0);
-    dataColor->AddRGBPoint(315.0,       1.0, 1.0, 0.0);
-    dataColor->AddRGBPoint(360.0,       1.0, 1.0, 1.0);
-
-
-
-    // Rainbow!!!
-/*
-    dataColor->AddRGBPoint(0.0,     0.0, 1.0, 1.0);
-    dataColor->AddRGBPoint(60.0,    0.0, 0.0, 1.0);
-    dataColor->AddRGBPoint(120.0,   1.0, 0.0, 1.0);
-    dataColor->AddRGBPoint(180.0,   1.0, 0.0, 0.0);
-    dataColor->AddRGBPoint(240.0,   1.0, 1.0, 0.0);
-    dataColor->AddRGBPoint(300.0,   0.0, 1.0, 0.0);
-    dataColor->AddRGBPoint(360.0,   0.0, 1.0, 1.0);
-*/
-
-
-
-    // 4 color with luminance gradient
-/*
-    double step = 0.001;
-
-    // Red
-    dataColor->AddRGBPoint(0.0,             0.625, 0.0, 0.0);
-    dataColor->AddRGBPoint(45.0,            1.0, 0.0, 0.0);      
 
-    // Green
-    dataColor->AddRGBPoint(45.0 + step,     0.0, 0.25, 0.0);
-    dataColor->AddRGBPoint(135.0,           0.0, 1.0, 0.0);
+bool VTKPipeline::IsInteracting() {
+    // The interactor style raises the desired update rate while moving
+    if (!interactor) return false;
 
-    // Cyan
-    dataColor->AddRGBPoint(135.0 + step,    0.0, 0.25, 0.25);
-    dataColor->AddRGBPoint(225.0,           0.0, 1.0, 1.0);
-
-    // Yellow
-    dataColor->AddRGBPoint(225.0 + step,    0.25, 0.25, 0.0);
-    dataColor->AddRGBPoint(315.0,           1.0, 1.0, 0.0);
+    return interactor->GetRenderWindow()->GetDesiredUpdateRate() > interactor->GetStillUpdateRate();
+}
 
-    // Back to red
-    dataColor->AddRGBPoint(315.0 + step,    0.25, 0.0, 0.0);
-    dataColor->AddRGBPoint(360.0,           0.625, 0.0, 0.0);
-*/
 
+void VTKPipeline::ComputeStatistics() {
+    // Make sure data is up-to-date.  The clip itself still runs here on the
+    // calling thread, as rendering needs the same output right after; only
+    // the statistics pass over the clip is progressive.
+    dataTriangle->Update();
 
+    // Compute statistics for all vector data in one pass, so switching
+    // vector data only needs to update the label.  Large clips start with
+    // an estimate and are refined in the background.
+    if (progressiveStatistics) statistics->Start(dataTriangle->GetOutput());
+    else statistics->Compute(dataTriangle->GetOutput());
 
-    // 8 colors with 2 luminance bands each
-/*
-    // Red
-    dataColor->AddRGBPoint(0.0,         0.5, 0.0, 0.0, 0.0, 1.0);
-    dataColor->AddRGBPoint(22.5,        1.0, 0.0, 0.0, 0.0, 1.0);
+    // Set the statistics label
+    UpdateStatisticsLabel();
 
-    // Orange
-    dataColor->AddRGBPoint(45.0,        0.5, 0.25, 0.0, 0.0, 1.0);
-    dataColor->AddRGBPoint(67.5,        1.0, 0.5, 0.0, 0.0, 1.0);
+    // Set the volume label
+    UpdateVolumeLabel();
+}
 
-    // Yellow
-    dataColor->AddRGBPoint(90.0,        0.5, 0.5, 0.0, 0.0, 1.0);
-    dataColor->AddRGBPoint(112.5,       1.0, 1.0, 0.0, 0.0, 1.0);
+bool VTKPipeline::UpdateStatistics() {
+    if (!statistics->Poll()) return false;
 
-    // White
-    dataColor->AddRGBPoint(135.0,       0.5, 0.5, 0.5, 0.0, 1.0);
-    dataColor->AddRGBPoint(157.5,       1.0, 1.0, 1.0, 0.0, 1.0);
+    UpdateStatisticsLabel();
+    UpdateVolumeLabel();
 
-    // Green
-    dataColor->AddRGBPoint(180.0,       0.0, 0.5, 0.0, 0.0, 1.0);
-    dataColor->AddRGBPoint(202.5,       0.0, 1.0, 0.0, 0.0, 1.0);
+    return true;
+}
 
-    // Cyan
-    dataColor->AddRGBPoint(225.0,       0.0, 0.5, 0.5, 0.0, 1.0);
-    dataColor->AddRGBPoint(247.5,       0.0, 1.0, 1.0, 0.0, 1.0);
+void VTKPipeline::FinishStatistics() {
+    if (statistics->IsExact()) return;
 
-    // Blue
-    dataColor->AddRGBPoint(270.0,       0.0, 0.0, 0.5, 0.0, 1.0);
-    dataColor->AddRGBPoint(292.5,       0.0, 0.0, 1.0, 0.0, 1.0);
+    statistics->Finish();
 
-    // Purple
-    dataColor->AddRGBPoint(315.0,       0.5, 0.0, 0.5, 0.0, 1.0);
-    dataColor->AddRGBPoint(337.5,       1.0, 0.0, 1.0, 0.0, 1.0);
+    UpdateStatisticsLabel();
+    UpdateVolumeLabel();
+}
 
-    // Back to red
-    dataColor->AddRGBPoint(360.0,       0.5, 0.0, 0.0, 0.0, 1.0);
-*/
+void VTKPipeline::ComputeClipStatistics(RegionStatistics& clipStatistics) {
+    // Reuse the statistics started by UpdateClipping()
+    FinishStatistics();
 
+    clipStatistics = statistics->GetStatistics();
+}
 
 
-    // 4 color
-/*
-    dataColor->AddRGBPoint(0.0,       1.0, 0.0, 0.0);
+const char* VTKPipeline::GetSizeName(bool clip) {
+    if (dataSet == RoofOffset || (clip && (clipType == CutX || clipType == CutY || clipType == CutZ))) {
+        return "Area";
+    }
 
-    dataColor->AddRGBPoint(90.0,      0.0, 1.0, 0.0);
+    return "Volume";
+}
 
-    dataColor->AddRGBPoint(180.0,     0.0, 0.0, 1.0);
+int VTKPipeline::GetSimplexValue() {
+    switch (vectorData) {
+        case XYAngle:
+            return XYAngleValue;
 
-    dataColor->AddRGBPoint(270.0,     1.0, 1.0, 0.0);
+        case ZComponent:
+            return ZComponentValue;
 
-    dataColor->AddRGBPoint(360.0,     1.0, 0.0, 0.0);
-*/
+        default:
+            return XYMagnitudeValue;
+    }
+}
 
-    
 
-    // Set an appropriate number of labels for the legend
-    legend->SetNumberOfLabels(9);
+void VTKPipeline::UpdatePipeline() {
+    dataMapper->Update();
 }
 
 
-void VTKPipeline::CreateDoubleEnded(double min, double max) {
-    // Create a double-ended color map
-/*
-    double minScale = 1.0;
-    double maxScale = 1.0;
+void VTKPipeline::ResetColorMapRange() {
+    double dataRange[2];
+    GetDataRange(dataRange);
 
-    if (max > abs(min)) {
-        minScale = abs(min) / max;
+    // Leave out outliers, except for angles
+    ScalarHistogram* histogram = colorMapRangeMode == PercentileRange && 
+                                 vectorData != XYAngle ? GetHistogram() : NULL;
+    if (histogram) {
+        SetColorMapRange(histogram->GetValue(lowPercentile), histogram->GetValue(highPercentile));
     }
-    else if (abs(min) > max) {
-        maxScale = max / abs(min);
+    else {
+        SetColorMapRange(dataRange[0], dataRange[1]);
     }
+}
 
-    dataColor->RemoveAllPoints();
 
-    dataColor->AddRGBPoint(min,           0.5 - 0.5 * minScale, 
-                                                0.5 - 0.5 * minScale, 
-                                                0.5 + 0.5 * minScale);
+ScalarHistogram* VTKPipeline::GetHistogram() {
+    vtkDataArray* scalars = vtkDataSet::SafeDownCast(dataAttribute->GetOutput())->GetPointData()->GetScalars();
+    if (!scalars) return NULL;
 
-    dataColor->AddRGBPoint(0.0,           0.5, 0.5, 0.5);
+    for (int i = 0; i < (int)histograms.size(); i++) {
+        if (histograms[i]->IsCurrent(scalars)) return histograms[i];
+    }
 
-    dataColor->AddRGBPoint(max,           0.5 + 0.5 * maxScale, 
-                                                0.5 - 0.5 * maxScale, 
-                                                0.5 - 0.5 * maxScale);
-*/
+    // Replace the oldest
+    if ((int)histograms.size() >= maxHistograms) {
+        delete histograms.front();
+        histograms.erase(histograms.begin());
+    }
 
-	// Create a Paraview-style double-ended color map
-/*
-	dataColor->SetColorSpaceToDiverging();
+    double range[2];
+    ranges->GetRange(scalars, 0, range);
 
-	dataColor->RemoveAllPoints();
+    ScalarHistogram* histogram = new ScalarHistogram();
+    histogram->Compute(scalars, range);
+    histograms.push_back(histogram);
 
-	dataColor->AddRGBPoint(min, 58.0 / 255.0, 76.0 / 255.0, 193.0 / 255.0);
-	dataColor->AddRGBPoint(max, 180.0 / 255.0, 4.0 / 255.0, 38.0 / 255.0);
-*/
+    return histogram;
+}
 
 
-	// Double-ended based on black-body
-    dataColor->RemoveAllPoints();
+void VTKPipeline::UpdateColorTable() {
+    // Sample the color map at the texel centers over the texture coordinate range
+    double range[2];
+    dataTextureCoordinates->GetRange(range);
 
-    dataColor->AddRGBPoint(min,         0.75, 1.0, 1.0);
-    dataColor->AddRGBPoint(min * 0.75,  0.0, 1.0, 1.0);
-    dataColor->AddRGBPoint(min * 0.1,   0.0, 0.0, 0.5);
-    dataColor->AddRGBPoint(0.0,         0.1, 0.1, 0.1);
-    dataColor->AddRGBPoint(max * 0.1,   0.5, 0.0, 0.0);
-    dataColor->AddRGBPoint(max * 0.75,  1.0, 1.0, 0.0);
-    dataColor->AddRGBPoint(max,         1.0, 1.0, 0.75);
+    unsigned char* texels = static_cast<unsigned char*>(dataColorTable->GetScalarPointer());
+    colorMap->GetTable(range[0], range[1], colorTableSize, 3, texels);
 
-        
-    // Set an appropriate number of labels for the legend
-    legend->SetNumberOfLabels(5);
+    dataColorTable->Modified();
 }
 
 
 void VTKPipeline::CreateColorWheel() {
     int numSegments = 256;
-    double radius = 30.0;
+    double radius = colorWheelRadius;
 
 
     vtkDoubleArray* data = vtkDoubleArray::New();
@@ -1536,17 +1875,26 @@ void VTKPipeline::CreateColorWheel() {
     data->Delete();
 
 
+    // Scale in pixels, for tiling
+    colorWheelScale = vtkTransform::New();
+
+    vtkTransformPolyDataFilter* scale = vtkTransformPolyDataFilter::New();
+    scale->SetInputConnection(disk->GetOutputPort());
+    scale->SetTransform(colorWheelScale);
+
+
     vtkCoordinate* coord = vtkCoordinate::New();
     coord->SetCoordinateSystemToViewport();
 
 
     vtkPolyDataMapper2D* mapper = vtkPolyDataMapper2D::New();
-    mapper->SetInputConnection(disk->GetOutputPort());
+    mapper->SetInputConnection(scale->GetOutputPort());
     mapper->SetTransformCoordinate(coord);
     mapper->SetLookupTable(dataColor);
     mapper->ScalarVisibilityOn();
 
     disk->Delete();
+    scale->Delete();
     coord->Delete();
 
 
@@ -1561,18 +1909,23 @@ void VTKPipeline::CreateColorWheel() {
 
 
     // Add a border
-    double border = 1.5;
+    double border = colorWheelBorder;
     vtkDiskSource* borderDisk = vtkDiskSource::New();
     borderDisk->SetRadialResolution(1);
     borderDisk->SetCircumferentialResolution(numSegments);
     borderDisk->SetOuterRadius(radius + border);
     borderDisk->SetInnerRadius(radius / 4.0 - border);   
+
+    vtkTransformPolyDataFilter* borderScale = vtkTransformPolyDataFilter::New();
+    borderScale->SetInputConnection(borderDisk->GetOutputPort());
+    borderScale->SetTransform(colorWheelScale);
     
     vtkPolyDataMapper2D* borderMapper = vtkPolyDataMapper2D::New();
-    borderMapper->SetInputConnection(borderDisk->GetOutputPort());
+    borderMapper->SetInputConnection(borderScale->GetOutputPort());
     borderMapper->SetTransformCoordinate(coord);
 
     borderDisk->Delete();
+    borderScale->Delete();
 
     colorWheelBorderActor = vtkActor2D::New();
     colorWheelBorderActor->SetMapper(borderMapper);
@@ -1586,6 +1939,23 @@ void VTKPipeline::CreateColorWheel() {
 }
 
 
+void VTKPipeline::SetOverlayScale(double scale) {
+    // Legend border, in normalized viewport coordinates
+    legendBorderPlane->SetPoint1(0.0, legendHeight * 0.47 * scale, 0.0);
+    legendBorderPlane->SetPoint2((legendWidth + 2.0 * legendBorder) * scale, 0.0, 0.0);
+
+    // Color wheel, in pixels
+    colorWheelScale->Identity();
+    colorWheelScale->Scale(scale, scale, 1.0);
+
+    // Labels
+    vtkTextActor* labels[5] = { statisticsLabel, volumeLabel, fileNameLabel, clipLabel, cameraLabel };
+    for (int i = 0; i < 5; i++) {
+        labels[i]->GetTextProperty()->SetFontSize((int)(labelFontSize * scale + 0.5));
+    }
+}
+
+
 void VTKPipeline::CreateLabels() {
     // Statistics label
     statisticsLabel = vtkTextActor::New();
@@ -1595,7 +1965,7 @@ void VTKPipeline::CreateLabels() {
     statisticsLabel->GetTextProperty()->BoldOn();
     statisticsLabel->GetTextProperty()->ItalicOn();
     statisticsLabel->GetTextProperty()->ShadowOff();
-    statisticsLabel->GetTextProperty()->SetFontSize(16);
+    statisticsLabel->GetTextProperty()->SetFontSize(labelFontSize);
     statisticsLabel->GetTextProperty()->SetJustificationToRight();
 
 
@@ -1607,7 +1977,7 @@ void VTKPipeline::CreateLabels() {
     volumeLabel->GetTextProperty()->BoldOn();
     volumeLabel->GetTextProperty()->ItalicOn();
     volumeLabel->GetTextProperty()->ShadowOff();
-    volumeLabel->GetTextProperty()->SetFontSize(16);
+    volumeLabel->GetTextProperty()->SetFontSize(labelFontSize);
     volumeLabel->GetTextProperty()->SetJustificationToLeft();
 
 
@@ -1620,7 +1990,7 @@ void VTKPipeline::CreateLabels() {
     fileNameLabel->GetTextProperty()->BoldOn();
     fileNameLabel->GetTextProperty()->ItalicOn();
     fileNameLabel->GetTextProperty()->ShadowOff();
-    fileNameLabel->GetTextProperty()->SetFontSize(16);
+    fileNameLabel->GetTextProperty()->SetFontSize(labelFontSize);
     fileNameLabel->GetTextProperty()->SetJustificationToCentered();
 
     // Clip label
@@ -1632,7 +2002,7 @@ void VTKPipeline::CreateLabels() {
     clipLabel->GetTextProperty()->BoldOn();
     clipLabel->GetTextProperty()->ItalicOn();
     clipLabel->GetTextProperty()->ShadowOff();
-    clipLabel->GetTextProperty()->SetFontSize(16);
+    clipLabel->GetTextProperty()->SetFontSize(labelFontSize);
     clipLabel->GetTextProperty()->SetJustificationToLeft();
 
     // Camera label
@@ -1644,57 +2014,86 @@ void VTKPipeline::CreateLabels() {
     cameraLabel->GetTextProperty()->BoldOn();
     cameraLabel->GetTextProperty()->ItalicOn();
     cameraLabel->GetTextProperty()->ShadowOff();
-    cameraLabel->GetTextProperty()->SetFontSize(16);
+    cameraLabel->GetTextProperty()->SetFontSize(labelFontSize);
     cameraLabel->GetTextProperty()->SetJustificationToLeft();
 }
 
-void VTKPipeline::UpdateStatisticsLabel(double min, double max, double mean) {
+void VTKPipeline::UpdateStatisticsLabel() {
     char buffer[512];
 
+    RegionStatistics& s = statistics->GetStatistics();
+
+    int value = GetSimplexValue();
+
+    // Until the exact statistics are available, show the min and max of the
+    // sample and the estimated mean with its 95% confidence interval
+    const char* estimate = statistics->IsExact() ? "" : " (Estimate)";
+
+    char mean[128];
+    if (statistics->IsExact()) {
+        sprintf(mean, "%g", s.GetMean(value));
+    }
+    else {
+        sprintf(mean, "%g +/- %g", s.GetMean(value), statistics->GetMeanError(value));
+    }
+
     switch (vectorData) {
         case XYMagnitude:
-            sprintf(buffer, "XY Velocity Magnitude Statistics:\nMin: %g m/s\nMax: %g m/s\nMean: %g m/s", min, max, mean);
+            sprintf(buffer, "XY Velocity Magnitude Statistics%s:\nMin: %g m/s\nMax: %g m/s\nMean: %s m/s",
+                    estimate, s.GetMin(value), s.GetMax(value), mean);
             break;
 
         case XYAngle:
-            sprintf(buffer, "XY Velocity Angle Statistics:\nMin: %g degrees\nMax: %g degrees\nMean: %g degrees", min, max, mean);
+            sprintf(buffer, "XY Velocity Angle Statistics%s:\nMin: %g degrees\nMax: %g degrees\nMean: %s degrees\nCircular Variance: %g",
+                    estimate, s.GetMin(value), s.GetMax(value), mean, s.GetCircularVariance());
             break;
 
         case ZComponent:
-            sprintf(buffer, "Z Velocity Component Statistics:\nMin: %g m/s\nMax: %g m/s\nMean: %g m/s", min, max, mean);
+            sprintf(buffer, "Z Velocity Component Statistics%s:\nMin: %g m/s\nMax: %g m/s\nMean: %s m/s",
+                    estimate, s.GetMin(value), s.GetMax(value), mean);
             break;
     }
     statisticsLabel->SetInput(buffer);
 }
 
-void VTKPipeline::UpdateVolumeLabel(double size) {
+void VTKPipeline::UpdateVolumeLabel() {
     char buffer[512];
 
     double clip[3];
     GetClippingBoxSize(clip);
     double clipSize;
 
+    double size = statistics->GetSize();
+
+    char cells[128];
+    if (statistics->IsExact()) {
+        sprintf(cells, "%g", size);
+    }
+    else {
+        sprintf(cells, "%g +/- %g", size, statistics->GetSizeError());
+    }
+
     switch (clipType) {
         case Extract:
         case FastClip:
         case AccurateClip:
             clipSize = clip[0] * clip[1] * clip[2];
-            sprintf(buffer, "Volume Statistics:\nClip: %g m^3\nCells: %g m^3\nDifference: %g m^3", clipSize, size, clipSize - size);
+            sprintf(buffer, "Volume Statistics:\nClip: %g m^3\nCells: %s m^3\nDifference: %g m^3", clipSize, cells, clipSize - size);
             break;
 
         case CutX:
             clipSize = clip[1] * clip[2];
-            sprintf(buffer, "Area Statistics:\n\tClip: %g m^2\nCells: %g m^2\nDifference: %g m^2", clipSize, size, clipSize - size);
+            sprintf(buffer, "Area Statistics:\n\tClip: %g m^2\nCells: %s m^2\nDifference: %g m^2", clipSize, cells, clipSize - size);
             break;
 
         case CutY:
             clipSize = clip[0] * clip[2];
-            sprintf(buffer, "Area Statistics:\nClip: %g m^2\nCells: %g m^2\nDifference: %g m^2", clipSize, size, clipSize - size);
+            sprintf(buffer, "Area Statistics:\nClip: %g m^2\nCells: %s m^2\nDifference: %g m^2", clipSize, cells, clipSize - size);
             break;
 
         case CutZ:
             clipSize = clip[0] * clip[1];
-            sprintf(buffer, "Area Statistics:\nClip: %g m^2\nCells: %g m^2\nDifference: %g m^2", clipSize, size, clipSize - size);
+            sprintf(buffer, "Area Statistics:\nClip: %g m^2\nCells: %s m^2\nDifference: %g m^2", clipSize, cells, clipSize - size);
             break;
     }
     volumeLabel->SetInput(buffer);
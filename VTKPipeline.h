@@ -21,6 +21,11 @@
 #define VTKPIPELINE_H
 
 
+#include "ColorMap.h"
+
+#include <vector>
+
+
 class vtkActor;
 class vtkActor2D;
 class vtkAssignAttribute;
@@ -30,28 +35,51 @@ class vtkCubeSource;
 class vtkCutter;
 class vtkDataSetMapper;
 class vtkDataSetTriangleFilter;
-class vtkDataSetSurfaceFilter;
 class vtkExtractGeometry;
+class vtkImageData;
 class vtkLinearExtrusionFilter;
 class vtkPlane;
-class vtkPointDataToCellData;
+class vtkPlaneSource;
+class vtkPolyDataMapper;
+class vtkRenderWindow;
 class vtkRenderWindowInteractor;
 class vtkRenderer;
 class vtkScalarBarActor;
 class vtkSTLReader;
 class vtkTextActor;
+class vtkTexture;
 class vtkTransform;
 class vtkXMLPolyDataReader;
 class vtkXMLUnstructuredGridReader;
 
 class vtkRendererCallback;
+class vtkScalarTextureCoordinates;
+class vtkScaleExtrusion;
+class vtkTetraSurfaceFilter;
 
-class MainWindow;
+class BackgroundWriter;
+class BuildingTiles;
+class LODBuilder;
+class ProgressiveStatistics;
+class RangeCache;
+class RegionStatistics;
+class ScalarHistogram;
+class ScreenshotQueue;
+class VerticalProfile;
+
+class PipelineObserver;
 
 
 class VTKPipeline {
 public:
-    VTKPipeline(vtkRenderWindowInteractor* rwi, MainWindow* qtWindow);
+    // The observer, e.g. the GUI, is told about changes made by interaction
+    VTKPipeline(vtkRenderWindowInteractor* rwi, PipelineObserver* pipelineObserver = NULL);
+
+    // Render offscreen without a GUI, e.g. for screenshots and movies on
+    // batch nodes.  Uses OSMesa if VTK was built with it, so no display
+    // or GPU is needed.
+    VTKPipeline(int width, int height);
+
     ~VTKPipeline();
 
     // Load data
@@ -59,12 +87,44 @@ public:
     void OpenMeshFile(const char* fileName);
     void OpenBuildingFile(const char* fileName);
 
-    // Save the clipped data
+    // Save the clipped data, as text, gzip compressed text or NumPy .npy/.npz depending on the extension.
+    // Rows are streamed to the file a chunk at a time, except for .npz.
     void SaveData(const char* fileName);
 
-    // Save a screenshot
+    // Save the data without building the clip in memory, either clipped to
+    // the clipping box or for the whole data set.  Supports text and .npy.
+    void StreamData(const char* fileName, bool clip);
+
+    // Save the clipped data as a VTK XML file in the background, using raw
+    // appended binary data.  .vtu saves the clip, .vtp saves its surface.
+    void SaveClip(const char* fileName, bool compress);
+
+    // Wait for the clip to be saved
+    void FinishClip();
+
+    // Check on work done in the background: saving the clip and building
+    // the decimated data shown during interaction
+    void UpdateBackground();
+
+    // Save a screenshot.  The window is captured immediately and the PNG
+    // file is written in the background.
     void SaveScreenshot(const char* fileName);
 
+    // Wait for screenshots to be written
+    void FinishScreenshots();
+
+    // Append the current camera view and clip settings to a movie path
+    // file as a keyframe at the given time in seconds
+    void AddMovieKeyframe(const char* fileName, double time);
+
+    // Render a movie along a path of keyframes, saving numbered PNG files
+    // starting with the prefix.  Frames are encoded in the background.
+    void SaveMovie(const char* pathFileName, const char* filePrefix, double frameRate, bool clip);
+
+    // Save a screenshot magnified by the given factor, rendered in tiles
+    // the size of the window and written a row of tiles at a time
+    void SaveLargeScreenshot(const char* fileName, int magnification);
+
     // Save/open a camera view
     void SaveCameraView(const char* fileName);
     void OpenCameraView(const char* fileName);
@@ -73,6 +133,26 @@ public:
     void SaveClipSettings(const char* fileName);
     void OpenClipSettings(const char* fileName);
 
+    // Compute statistics for clipping boxes read from a file with one box 
+    // per line, in the same format as SaveClipSettings(), and save a table
+    void SaveBatchStatistics(const char* boxFileName, const char* fileName);
+
+    // Check for exact statistics computed in the background, updating the
+    // labels.  Returns true if the labels changed.
+    bool UpdateStatistics();
+
+    // Wait for the exact statistics of the current clip, updating the labels
+    void FinishStatistics();
+
+    // Exact statistics of the current clip, waiting for them if needed.
+    // Call after UpdateClipping().
+    void ComputeClipStatistics(RegionStatistics& clipStatistics);
+
+    // Vertical profile of the current clip, in bands of the given height
+    void ComputeProfile(double binWidth);
+    VerticalProfile* GetProfile();
+    void SaveProfile(const char* fileName);
+
     // Get/set showing data
     bool GetShowData();
     void SetShowData(bool show);
@@ -141,8 +221,26 @@ public:
 
     // Get/set data and color map range
     void GetDataRange(double range[2]);
+    void GetColorMapRange(double range[2]);
     void SetColorMapRange(double min, double max);
 
+    // How the color map range is set when the data changes.  Equalized spreads
+    // sequential color maps over the data by quantile.
+    enum ColorMapRangeMode {
+        FullRange,
+        PercentileRange,
+        EqualizedRange
+    };
+    ColorMapRangeMode GetColorMapRangeMode();
+    void SetColorMapRangeMode(ColorMapRangeMode mode);
+
+    // Kind of color map used for the current vector data and range
+    ColorMap::Kind GetColorMapKind();
+
+    // Get/set the color map, from those in ColorMap.  The choice is kept for each kind.
+    int GetColorMap();
+    void SetColorMap(int map);
+
     // Force a render
     void Render();
 
@@ -159,30 +257,41 @@ public:
     void SetShowDataStatisticsLabel(bool show);
     void SetShowFileNameLabel(bool show);
 
-    // Get/set the camera
+    // Get/set the camera.  Setting doesn't render, so the caller can combine changes.
     void GetCameraPosition(double position[4]);
     void SetCameraPosition(double x, double y, double z, double d);
     void GetCameraRotation(double rotation[4]);
     void SetCameraRotation(double w, double x, double y, double z);
 
-    // Reset the camera
+    // Reset the camera, without rendering
     void ResetCameraX();
     void ResetCameraY();
     void ResetCameraZ();
 
+    // Update the camera label and widgets after the view changes
     void UpdateCamera();
 
+    // Average time spent in UpdateCamera() per render, in seconds
+    double GetCameraUpdateCost();
+
+    // Render the decimated data while the camera is moving, and
+    // simplified buildings far from the camera
+    void UpdateDataDetail();
+
 protected:
-    // The Qt main window
-    MainWindow* mainWindow;
+    // Receives updates, may be NULL
+    PipelineObserver* observer;
 
-    // Rendering
+    // Rendering.  The interactor is NULL when rendering offscreen.
     vtkRenderWindowInteractor* interactor;
+    vtkRenderWindow* renderWindow;
+    bool ownsRenderWindow;
     vtkRenderer* renderer;
 
     // Roof offset objects
     vtkXMLPolyDataReader* roofOffsetReader;
     vtkLinearExtrusionFilter* roofOffsetExtrusion;
+    vtkScaleExtrusion* roofOffsetThickness;
 
     // Mesh data objects
     vtkXMLUnstructuredGridReader* meshReader;
@@ -190,16 +299,30 @@ protected:
     // Data objects  
     vtkAssignAttribute* dataAttribute;
     vtkDataSetTriangleFilter* dataTriangle;
-    vtkDataSetSurfaceFilter* dataSurface;
-    vtkPointDataToCellData* dataCellData;
+    vtkTetraSurfaceFilter* dataSurface;
+    vtkScalarTextureCoordinates* dataTextureCoordinates;
     vtkColorTransferFunction* dataColor;
+    ColorMap* colorMap;
+    int selectedColorMaps[3];
+    double colorMapRange[2];
+    ColorMapRangeMode colorMapRangeMode;
+
+    // Ranges and histograms of recently shown arrays
+    RangeCache* ranges;
+    std::vector<ScalarHistogram*> histograms;
+    vtkImageData* dataColorTable;
+    vtkTexture* dataColorTexture;
     vtkDataSetMapper* dataMapper;
+
+    // Decimated data for interaction
+    LODBuilder* dataLOD;
+    vtkPolyDataMapper* dataLODMapper;
     vtkActor* dataActor;
     vtkActor* contourActor;
 
     // Building objects
     vtkSTLReader* buildingReader;
-    vtkActor* buildingActor;
+    BuildingTiles* buildingTiles;
 
     // Clipping
     vtkTransform* clippingBoxTransform;
@@ -221,8 +344,10 @@ protected:
     // Color map legend
     vtkScalarBarActor* legend;
     vtkActor2D* legendBorderActor;
+    vtkPlaneSource* legendBorderPlane;
     vtkActor2D* colorWheelActor;
     vtkActor2D* colorWheelBorderActor;
+    vtkTransform* colorWheelScale;
 
     // Labels
     vtkTextActor* statisticsLabel;
@@ -234,32 +359,73 @@ protected:
     // Callback for rendering
     vtkRendererCallback* rendererCallback;
 
+    // Camera view last checked, and what is out of date
+    double cameraView[9];
+    double cameraUpdateTime;
+    bool cameraLabelChanged;
+    bool cameraWidgetsChanged;
+    double cameraUpdateCost;
+
+    // Statistics of the current clip for all vector data
+    ProgressiveStatistics* statistics;
+
+    // Estimate large clips first and refine them in the background.  Off
+    // while rendering movies, where each frame needs the exact values.
+    bool progressiveStatistics;
+
+    // Vertical profile
+    VerticalProfile* profile;
+
+    // Background writer for saving the clip
+    BackgroundWriter* clipWriter;
+
+    // Screenshots waiting to be written
+    ScreenshotQueue* screenshotQueue;
+
     // Which data
     DataSet dataSet;
     VectorData vectorData;
 
-    // Compute the mean of the wind velocities
-    // XXX: Should move to a VTK filter?
+    // True while the camera is being moved with the mouse
+    bool IsInteracting();
+
+    // Compute the statistics of the wind velocities for the current clip
     void ComputeStatistics();
 
+    // Index of the current vector data in the simplex values
+    int GetSimplexValue();
+
+    // Name of the area/volume column when saving data
+    const char* GetSizeName(bool clip);
+
     // Force a pipeline update
     void UpdatePipeline();
 
     // Reset the color map range to the full data range
     void ResetColorMapRange();
 
-    // Different color maps
-    void CreateBlackBody(double min, double max);
-    void CreateCircular();
-    void CreateDoubleEnded(double min, double max);
+    // Resample the color map into the color map texture
+    void UpdateColorTable();
+
+    // Histogram of the current scalars, computed if not cached
+    ScalarHistogram* GetHistogram();
+
+    // Build the pipeline, once the render window is set
+    void Initialize();
+
+    // Render without resetting the clipping range
+    void RenderView();
 
     // Legend aid for angles
     void CreateColorWheel();
 
+    // Scale the legend border, color wheel and labels for a magnified image
+    void SetOverlayScale(double scale);
+
     // Labels
     void CreateLabels();
-    void UpdateStatisticsLabel(double min, double max, double mean);
-    void UpdateVolumeLabel(double size);
+    void UpdateStatisticsLabel();
+    void UpdateVolumeLabel();
     void UpdateClipLabel();
     void UpdateCameraLabel();
 };
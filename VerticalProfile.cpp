@@ -0,0 +1,222 @@
+/*=========================================================================
+
+  Name:        VerticalProfile.cpp
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+  Description: Computes statistics of the wind data in horizontal bands
+               of a given height, in one multithreaded pass.
+
+=========================================================================*/
+
+
+#include "VerticalProfile.h"
+
+#include "BoxClipper.h"
+#include "SimplexReader.h"
+
+#include "VTKPipeline.h"
+
+#include <vtkDataSet.h>
+
+#include <fstream>
+#include <iostream>
+
+#include <math.h>
+
+
+// Limit on the number of bands, in case of a tiny bin width
+static const int maxBins = 10000;
+
+
+VerticalProfile::VerticalProfile() {
+    input = NULL;
+    binWidth = 10.0;
+    origin = 0.0;
+}
+
+VerticalProfile::~VerticalProfile() {
+}
+
+
+void VerticalProfile::SetInput(vtkDataSet* data) {
+    input = data;
+}
+
+
+void VerticalProfile::SetBinWidth(double width) {
+    binWidth = width;
+}
+
+double VerticalProfile::GetBinWidth() {
+    return binWidth;
+}
+
+
+void VerticalProfile::Update() {
+    statistics.clear();
+
+    if (input == NULL || input->GetNumberOfCells() == 0 || binWidth <= 0.0) return;
+
+    input->GetBounds(inputBounds);
+
+    // Align bands with multiples of the bin width
+    origin = floor(inputBounds[4] / binWidth) * binWidth;
+    int numBins = (int)ceil((inputBounds[5] - origin) / binWidth);
+    numBins = numBins < 1 ? 1 : numBins;
+
+    if (numBins > maxBins) {
+        std::cout << "Bin width " << binWidth << " too small for height range "
+                  << inputBounds[5] - inputBounds[4] << std::endl;
+        return;
+    }
+
+    statistics.assign(numBins, RegionStatistics());
+
+    // Make the data safe to read from multiple threads
+    SimplexReader::Prepare(input);
+
+    // One pass over the data, split between threads
+    vtkMultiThreader* threader = vtkMultiThreader::New();
+    threadStatistics.resize(threader->GetNumberOfThreads());
+    threader->SetSingleMethod(ThreadFunction, this);
+    threader->SingleMethodExecute();
+    threader->Delete();
+
+    // Combine the results from each thread
+    for (int i = 0; i < (int)threadStatistics.size(); i++) {
+        for (int j = 0; j < numBins && j < (int)threadStatistics[i].size(); j++) {
+            statistics[j].Add(threadStatistics[i][j]);
+        }
+    }
+
+    threadStatistics.clear();
+}
+
+
+int VerticalProfile::GetNumberOfBins() {
+    return (int)statistics.size();
+}
+
+double VerticalProfile::GetBinBottom(int bin) {
+    return origin + bin * binWidth;
+}
+
+double VerticalProfile::GetBinTop(int bin) {
+    return origin + (bin + 1) * binWidth;
+}
+
+
+RegionStatistics& VerticalProfile::GetStatistics(int bin) {
+    return statistics[bin];
+}
+
+
+bool VerticalProfile::WriteTable(const char* fileName) {
+    std::ofstream file;
+    file.open(fileName);
+
+    if (!file.good()) {
+        std::cout << "Could not open " << fileName << " for writing" << std::endl;
+        return false;
+    }
+
+    // Write header
+    file << "Bottom, Top, ";
+    RegionStatistics::WriteHeader(file);
+    file << std::endl;
+
+    for (int i = 0; i < GetNumberOfBins(); i++) {
+        file << GetBinBottom(i) << ", " << GetBinTop(i) << ", ";
+        statistics[i].Write(file);
+        file << std::endl;
+    }
+
+    file.close();
+
+    return true;
+}
+
+
+VTK_THREAD_RETURN_TYPE VerticalProfile::ThreadFunction(void* arg) {
+    vtkMultiThreader::ThreadInfo* info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+    VerticalProfile* self = static_cast<VerticalProfile*>(info->UserData);
+
+    self->ThreadExecute(info->ThreadID, info->NumberOfThreads);
+
+    return VTK_THREAD_RETURN_VALUE;
+}
+
+void VerticalProfile::ThreadExecute(int thread, int numThreads) {
+    int numBins = (int)statistics.size();
+
+    std::vector<RegionStatistics>& stats = threadStatistics[thread];
+    stats.assign(numBins, RegionStatistics());
+
+    // Each band is a box covering the data in x and y
+    double center[3] = { (inputBounds[0] + inputBounds[1]) * 0.5,
+                         (inputBounds[2] + inputBounds[3]) * 0.5,
+                         0.0 };
+    double size[3] = { inputBounds[1] - inputBounds[0] + 1.0,
+                       inputBounds[3] - inputBounds[2] + 1.0,
+                       binWidth };
+    BoxClipper band;
+
+    SimplexReader reader(input);
+
+    std::vector<Simplex> simplices;
+    std::vector<Simplex> pieces;
+
+    vtkIdType numCells = input->GetNumberOfCells();
+    vtkIdType start = numCells * thread / numThreads;
+    vtkIdType end = numCells * (thread + 1) / numThreads;
+
+    for (vtkIdType cellId = start; cellId < end; cellId++) {
+        simplices.clear();
+        reader.GetSimplices(cellId, simplices);
+
+        for (int i = 0; i < (int)simplices.size(); i++) {
+            Simplex& s = simplices[i];
+
+            // Bands covered
+            double zMin = s.p[0].x[2];
+            double zMax = zMin;
+            for (int j = 1; j < s.numberOfPoints; j++) {
+                zMin = s.p[j].x[2] < zMin ? s.p[j].x[2] : zMin;
+                zMax = s.p[j].x[2] > zMax ? s.p[j].x[2] : zMax;
+            }
+
+            int bin0 = (int)floor((zMin - origin) / binWidth);
+            int bin1 = (int)floor((zMax - origin) / binWidth);
+            bin0 = bin0 < 0 ? 0 : bin0 >= numBins ? numBins - 1 : bin0;
+            bin1 = bin1 < 0 ? 0 : bin1 >= numBins ? numBins - 1 : bin1;
+
+            if (bin0 == bin1) {
+                stats[bin0].AddSimplex(s, BoxClipper::ComputeMeasure(s));
+                continue;
+            }
+
+            // Split between bands
+            for (int bin = bin0; bin <= bin1; bin++) {
+                center[2] = origin + (bin + 0.5) * binWidth;
+                band.SetBox(center, size, 0.0, VTKPipeline::AccurateClip);
+
+                pieces.clear();
+                band.Clip(s, pieces);
+
+                for (int j = 0; j < (int)pieces.size(); j++) {
+                    double measure = BoxClipper::ComputeMeasure(pieces[j]);
+                    if (measure > 0.0) stats[bin].AddSimplex(pieces[j], measure);
+                }
+            }
+        }
+    }
+}
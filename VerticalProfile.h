@@ -0,0 +1,75 @@
+/*=========================================================================
+
+  Name:        VerticalProfile.h
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+  Description: Computes statistics of the wind data in horizontal bands
+               of a given height, in one multithreaded pass.
+
+=========================================================================*/
+
+
+#ifndef VERTICALPROFILE_H
+#define VERTICALPROFILE_H
+
+
+#include "RegionStatistics.h"
+
+#include <vtkMultiThreader.h>
+
+#include <vector>
+
+class vtkDataSet;
+
+
+class VerticalProfile {
+public:
+    VerticalProfile();
+    ~VerticalProfile();
+
+    // Data to compute the profile for, usually the current clip
+    void SetInput(vtkDataSet* data);
+
+    // Height of each band
+    void SetBinWidth(double width);
+    double GetBinWidth();
+
+    // Compute the profile.  Cells spanning bands are clipped at the band boundaries.
+    void Update();
+
+    int GetNumberOfBins();
+    double GetBinBottom(int bin);
+    double GetBinTop(int bin);
+
+    RegionStatistics& GetStatistics(int bin);
+
+    // Write a table with one row per band
+    bool WriteTable(const char* fileName);
+
+protected:
+    vtkDataSet* input;
+
+    double binWidth;
+    double origin;
+
+    std::vector<RegionStatistics> statistics;
+
+    // Per-thread results
+    std::vector< std::vector<RegionStatistics> > threadStatistics;
+    double inputBounds[6];
+
+    static VTK_THREAD_RETURN_TYPE ThreadFunction(void* arg);
+    void ThreadExecute(int thread, int numThreads);
+};
+
+
+#endif
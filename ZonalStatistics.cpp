@@ -0,0 +1,312 @@
+/*=========================================================================
+
+  Name:        ZonalStatistics.cpp
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+  Description: Computes statistics for many clipping boxes in one
+               multithreaded pass over the data.
+
+=========================================================================*/
+
+
+#include "ZonalStatistics.h"
+
+#include "BoxClipper.h"
+#include "SimplexReader.h"
+
+#include <vtkDataSet.h>
+
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include <math.h>
+#include <stdio.h>
+
+
+ZonalStatistics::ZonalStatistics() {
+    input = NULL;
+}
+
+ZonalStatistics::~ZonalStatistics() {
+}
+
+
+void ZonalStatistics::SetInput(vtkDataSet* data) {
+    input = data;
+}
+
+
+void ZonalStatistics::AddBox(const double center[3], const double size[3], double rotation, int clipType) {
+    Box box;
+    for (int i = 0; i < 3; i++) {
+        box.center[i] = center[i];
+        box.size[i] = size[i];
+    }
+    box.rotation = rotation;
+    box.clipType = clipType;
+
+    boxes.push_back(box);
+}
+
+void ZonalStatistics::RemoveAllBoxes() {
+    boxes.clear();
+    statistics.clear();
+}
+
+int ZonalStatistics::GetNumberOfBoxes() {
+    return (int)boxes.size();
+}
+
+
+bool ZonalStatistics::ReadBoxes(const char* fileName) {
+    std::ifstream file;
+    file.open(fileName);
+
+    if (!file.good()) {
+        std::cout << "Could not open " << fileName << " for reading" << std::endl;
+        return false;
+    }
+
+    // Any line that doesn't parse is treated as a header, so files
+    // saved with VTKPipeline::SaveClipSettings() can be concatenated
+    std::string line;
+    while (std::getline(file, line)) {
+        double c[3];
+        double s[3];
+        double r;
+        int t;
+
+        if (sscanf(line.c_str(), "%lf %lf %lf %lf %lf %lf %lf %d",
+                   &c[0], &c[1], &c[2], &s[0], &s[1], &s[2], &r, &t) == 8) {
+            AddBox(c, s, r, t);
+        }
+    }
+
+    file.close();
+
+    return true;
+}
+
+
+void ZonalStatistics::Update() {
+    statistics.assign(boxes.size(), RegionStatistics());
+
+    if (input == NULL || boxes.size() == 0) return;
+
+    // Make the data safe to read from multiple threads
+    SimplexReader::Prepare(input);
+
+    BuildGrid();
+
+    // One pass over the data, split between threads
+    vtkMultiThreader* threader = vtkMultiThreader::New();
+    threadStatistics.resize(threader->GetNumberOfThreads());
+    threader->SetSingleMethod(ThreadFunction, this);
+    threader->SingleMethodExecute();
+    threader->Delete();
+
+    // Combine the results from each thread
+    for (int i = 0; i < (int)threadStatistics.size(); i++) {
+        for (int j = 0; j < (int)statistics.size() && j < (int)threadStatistics[i].size(); j++) {
+            statistics[j].Add(threadStatistics[i][j]);
+        }
+    }
+
+    threadStatistics.clear();
+}
+
+
+RegionStatistics& ZonalStatistics::GetStatistics(int box) {
+    return statistics[box];
+}
+
+
+bool ZonalStatistics::WriteTable(const char* fileName) {
+    std::ofstream file;
+    file.open(fileName);
+
+    if (!file.good()) {
+        std::cout << "Could not open " << fileName << " for writing" << std::endl;
+        return false;
+    }
+
+    // Write header
+    file << "Box, Center X, Center Y, Center Z, Size X, Size Y, Size Z, Rotation, Type, ";
+    RegionStatistics::WriteHeader(file);
+    file << std::endl;
+
+    for (int i = 0; i < (int)boxes.size() && i < (int)statistics.size(); i++) {
+        Box& b = boxes[i];
+
+        file << i << ", "
+             << b.center[0] << ", " << b.center[1] << ", " << b.center[2] << ", "
+             << b.size[0] << ", " << b.size[1] << ", " << b.size[2] << ", "
+             << b.rotation << ", " << b.clipType << ", ";
+        statistics[i].Write(file);
+        file << std::endl;
+    }
+
+    file.close();
+
+    return true;
+}
+
+
+void ZonalStatistics::BuildGrid() {
+    // World-space bounds of each box, and of all boxes
+    boxBounds.resize(boxes.size());
+
+    double bounds[4] = { VTK_DOUBLE_MAX, -VTK_DOUBLE_MAX, VTK_DOUBLE_MAX, -VTK_DOUBLE_MAX };
+
+    BoxClipper clipper;
+    for (int i = 0; i < (int)boxes.size(); i++) {
+        clipper.SetBox(boxes[i].center, boxes[i].size, boxes[i].rotation, boxes[i].clipType);
+
+        boxBounds[i].resize(6);
+        clipper.GetBounds(&boxBounds[i][0]);
+
+        bounds[0] = boxBounds[i][0] < bounds[0] ? boxBounds[i][0] : bounds[0];
+        bounds[1] = boxBounds[i][1] > bounds[1] ? boxBounds[i][1] : bounds[1];
+        bounds[2] = boxBounds[i][2] < bounds[2] ? boxBounds[i][2] : bounds[2];
+        bounds[3] = boxBounds[i][3] > bounds[3] ? boxBounds[i][3] : bounds[3];
+    }
+
+    // A few boxes per grid cell on average
+    int n = (int)ceil(sqrt((double)boxes.size())) * 2;
+    n = n < 1 ? 1 : n > 256 ? 256 : n;
+
+    for (int i = 0; i < 2; i++) {
+        gridSize[i] = n;
+        gridOrigin[i] = bounds[i * 2];
+        gridSpacing[i] = (bounds[i * 2 + 1] - bounds[i * 2]) / n;
+        if (gridSpacing[i] <= 0.0) gridSpacing[i] = 1.0;
+    }
+
+    grid.assign(gridSize[0] * gridSize[1], std::vector<int>());
+
+    for (int i = 0; i < (int)boxes.size(); i++) {
+        int x0 = (int)floor((boxBounds[i][0] - gridOrigin[0]) / gridSpacing[0]);
+        int x1 = (int)floor((boxBounds[i][1] - gridOrigin[0]) / gridSpacing[0]);
+        int y0 = (int)floor((boxBounds[i][2] - gridOrigin[1]) / gridSpacing[1]);
+        int y1 = (int)floor((boxBounds[i][3] - gridOrigin[1]) / gridSpacing[1]);
+
+        x0 = x0 < 0 ? 0 : x0;
+        y0 = y0 < 0 ? 0 : y0;
+        x1 = x1 >= gridSize[0] ? gridSize[0] - 1 : x1;
+        y1 = y1 >= gridSize[1] ? gridSize[1] - 1 : y1;
+
+        for (int y = y0; y <= y1; y++) {
+            for (int x = x0; x <= x1; x++) {
+                grid[y * gridSize[0] + x].push_back(i);
+            }
+        }
+    }
+}
+
+
+VTK_THREAD_RETURN_TYPE ZonalStatistics::ThreadFunction(void* arg) {
+    vtkMultiThreader::ThreadInfo* info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+    ZonalStatistics* self = static_cast<ZonalStatistics*>(info->UserData);
+
+    self->ThreadExecute(info->ThreadID, info->NumberOfThreads);
+
+    return VTK_THREAD_RETURN_VALUE;
+}
+
+void ZonalStatistics::ThreadExecute(int thread, int numThreads) {
+    int numBoxes = (int)boxes.size();
+
+    std::vector<RegionStatistics>& stats = threadStatistics[thread];
+    stats.assign(numBoxes, RegionStatistics());
+
+    // Each thread needs its own clippers and reader for their work space
+    std::vector<BoxClipper> clippers(numBoxes);
+    for (int i = 0; i < numBoxes; i++) {
+        clippers[i].SetBox(boxes[i].center, boxes[i].size, boxes[i].rotation, boxes[i].clipType);
+    }
+
+    SimplexReader reader(input);
+
+    // Last cell visited for each box, as a cell can overlap multiple grid cells
+    std::vector<vtkIdType> visited(numBoxes, -1);
+
+    std::vector<Simplex> simplices;
+    std::vector<Simplex> pieces;
+
+    vtkIdType numCells = input->GetNumberOfCells();
+    vtkIdType start = numCells * thread / numThreads;
+    vtkIdType end = numCells * (thread + 1) / numThreads;
+
+    for (vtkIdType cellId = start; cellId < end; cellId++) {
+        simplices.clear();
+        reader.GetSimplices(cellId, simplices);
+
+        if (simplices.size() == 0) continue;
+
+        // Cell bounds
+        double cb[6] = { VTK_DOUBLE_MAX, -VTK_DOUBLE_MAX,
+                         VTK_DOUBLE_MAX, -VTK_DOUBLE_MAX,
+                         VTK_DOUBLE_MAX, -VTK_DOUBLE_MAX };
+        for (int i = 0; i < (int)simplices.size(); i++) {
+            for (int j = 0; j < simplices[i].numberOfPoints; j++) {
+                const double* x = simplices[i].p[j].x;
+                for (int k = 0; k < 3; k++) {
+                    cb[k * 2] = x[k] < cb[k * 2] ? x[k] : cb[k * 2];
+                    cb[k * 2 + 1] = x[k] > cb[k * 2 + 1] ? x[k] : cb[k * 2 + 1];
+                }
+            }
+        }
+
+        // Grid cells overlapped
+        int x0 = (int)floor((cb[0] - gridOrigin[0]) / gridSpacing[0]);
+        int x1 = (int)floor((cb[1] - gridOrigin[0]) / gridSpacing[0]);
+        int y0 = (int)floor((cb[2] - gridOrigin[1]) / gridSpacing[1]);
+        int y1 = (int)floor((cb[3] - gridOrigin[1]) / gridSpacing[1]);
+
+        if (x1 < 0 || y1 < 0 || x0 >= gridSize[0] || y0 >= gridSize[1]) continue;
+
+        x0 = x0 < 0 ? 0 : x0;
+        y0 = y0 < 0 ? 0 : y0;
+        x1 = x1 >= gridSize[0] ? gridSize[0] - 1 : x1;
+        y1 = y1 >= gridSize[1] ? gridSize[1] - 1 : y1;
+
+        for (int y = y0; y <= y1; y++) {
+            for (int x = x0; x <= x1; x++) {
+                std::vector<int>& candidates = grid[y * gridSize[0] + x];
+
+                for (int i = 0; i < (int)candidates.size(); i++) {
+                    int b = candidates[i];
+
+                    if (visited[b] == cellId) continue;
+                    visited[b] = cellId;
+
+                    // Check bounds overlap
+                    std::vector<double>& bb = boxBounds[b];
+                    if (cb[0] > bb[1] || cb[1] < bb[0] ||
+                        cb[2] > bb[3] || cb[3] < bb[2] ||
+                        cb[4] > bb[5] || cb[5] < bb[4]) continue;
+
+                    // Clip and accumulate
+                    pieces.clear();
+                    for (int j = 0; j < (int)simplices.size(); j++) {
+                        clippers[b].Clip(simplices[j], pieces);
+                    }
+
+                    for (int j = 0; j < (int)pieces.size(); j++) {
+                        stats[b].AddSimplex(pieces[j], BoxClipper::ComputeMeasure(pieces[j]));
+                    }
+                }
+            }
+        }
+    }
+}
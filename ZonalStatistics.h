@@ -0,0 +1,88 @@
+/*=========================================================================
+
+  Name:        ZonalStatistics.h
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+  Description: Computes statistics for many clipping boxes in one
+               multithreaded pass over the data.
+
+=========================================================================*/
+
+
+#ifndef ZONALSTATISTICS_H
+#define ZONALSTATISTICS_H
+
+
+#include "RegionStatistics.h"
+
+#include <vtkMultiThreader.h>
+
+#include <vector>
+
+class vtkDataSet;
+
+
+class ZonalStatistics {
+public:
+    ZonalStatistics();
+    ~ZonalStatistics();
+
+    // Data to compute statistics on
+    void SetInput(vtkDataSet* data);
+
+    // Clipping boxes, using the same parameters as VTKPipeline
+    void AddBox(const double center[3], const double size[3], double rotation, int clipType);
+    void RemoveAllBoxes();
+    int GetNumberOfBoxes();
+
+    // Read boxes from a file, one per line, in the same format as VTKPipeline::SaveClipSettings()
+    bool ReadBoxes(const char* fileName);
+
+    // Compute statistics for all boxes
+    void Update();
+
+    RegionStatistics& GetStatistics(int box);
+
+    // Write a table with one row per box
+    bool WriteTable(const char* fileName);
+
+protected:
+    vtkDataSet* input;
+
+    struct Box {
+        double center[3];
+        double size[3];
+        double rotation;
+        int clipType;
+    };
+    std::vector<Box> boxes;
+
+    std::vector<RegionStatistics> statistics;
+
+    // Uniform grid in x and y for finding the boxes overlapping a cell
+    int gridSize[2];
+    double gridOrigin[2];
+    double gridSpacing[2];
+    std::vector< std::vector<int> > grid;
+    std::vector< std::vector<double> > boxBounds;
+
+    void BuildGrid();
+
+    // Per-thread results
+    std::vector< std::vector<RegionStatistics> > threadStatistics;
+
+    static VTK_THREAD_RETURN_TYPE ThreadFunction(void* arg);
+    void ThreadExecute(int thread, int numThreads);
+};
+
+
+#endif
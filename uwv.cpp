@@ -4,19 +4,104 @@
 
   Author:      David Borland
 
-  Description: Contains the main function for the uwv (Urban Wind 
-               Visualization) program.  Just instantiates a QApplication 
+  Description: Contains the main function for the uwv (Urban Wind
+               Visualization) program.  Just instantiates a QApplication
                object and the application main window using Qt.
 
+               Can also be run from the command line without the GUI:
+
+               uwv --statistics <data file> <box file> <output file>
+
+               computes statistics for each clipping box in the box
+               file (same format as Save Clip Settings, one box per
+               line) and saves them as a table.
+
+               uwv --batch <job file>
+
+               runs the jobs in a JSON job file offscreen, saving 
+               statistics, exports and screenshots for sequences of 
+               clip settings and camera views.  See JobRunner.h for 
+               the format.
+
 =========================================================================*/
 
 
 #include "MainWindow.h"
 
+#include "JobRunner.h"
+#include "ZonalStatistics.h"
+
 #include <qapplication.h>
 
+#include <vtkDataSet.h>
+#include <vtkXMLPolyDataReader.h>
+#include <vtkXMLUnstructuredGridReader.h>
+
+#include <iostream>
+#include <string>
+
+#include <string.h>
+
+
+int BatchStatistics(const char* dataFileName, const char* boxFileName, const char* outputFileName) {
+    ZonalStatistics statistics;
+    if (!statistics.ReadBoxes(boxFileName)) return -1;
+
+    // Roof offsets are poly data, meshes are unstructured grids
+    std::string name = dataFileName;
+    bool polyData = name.size() > 4 && name.substr(name.size() - 4) == ".vtp";
+
+    vtkXMLPolyDataReader* roofOffsetReader = vtkXMLPolyDataReader::New();
+    vtkXMLUnstructuredGridReader* meshReader = vtkXMLUnstructuredGridReader::New();
+
+    vtkDataSet* data;
+    if (polyData) {
+        roofOffsetReader->SetFileName(dataFileName);
+        roofOffsetReader->Update();
+        data = roofOffsetReader->GetOutput();
+    }
+    else {
+        meshReader->SetFileName(dataFileName);
+        meshReader->Update();
+        data = meshReader->GetOutput();
+    }
+
+    std::cout << "Computing statistics for " << statistics.GetNumberOfBoxes() << " boxes" << std::endl;
+
+    statistics.SetInput(data);
+    statistics.Update();
+
+    bool success = statistics.WriteTable(outputFileName);
+
+    roofOffsetReader->Delete();
+    meshReader->Delete();
+
+    return success ? 0 : -1;
+}
+
 
 int main(int argc, char** argv) {
+    // Command-line statistics
+    if (argc > 1 && strcmp(argv[1], "--statistics") == 0) {
+        if (argc != 5) {
+            std::cout << "Usage: uwv --statistics <data file> <box file> <output file>" << std::endl;
+            return -1;
+        }
+
+        return BatchStatistics(argv[2], argv[3], argv[4]);
+    }
+
+    // Job files
+    if (argc > 1 && strcmp(argv[1], "--batch") == 0) {
+        if (argc != 3) {
+            std::cout << "Usage: uwv --batch <job file>" << std::endl;
+            return -1;
+        }
+
+        JobRunner runner;
+        return runner.Run(argv[2]) ? 0 : -1;
+    }
+
     // Initialize Qt
     QApplication app(argc, argv);
 
@@ -0,0 +1,31 @@
+/*=========================================================================
+
+  Name:        uwvbatch.cpp
+
+  Author:      David Borland
+
+  Description: Contains the main function for uwvbatch, which runs the
+               jobs in a JSON job file offscreen, like uwv --batch, but
+               without Qt:
+
+               uwvbatch <job file>
+
+               See JobRunner.h for the format.
+
+=========================================================================*/
+
+
+#include "JobRunner.h"
+
+#include <iostream>
+
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        std::cout << "Usage: uwvbatch <job file>" << std::endl;
+        return -1;
+    }
+
+    JobRunner runner;
+    return runner.Run(argv[1]) ? 0 : -1;
+}
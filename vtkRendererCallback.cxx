@@ -39,4 +39,5 @@ void vtkRendererCallback::Execute(vtkObject* caller, unsigned long eventId, void
     if (eventId != StartEvent) return;
 
     pipeline->UpdateCamera();
+    pipeline->UpdateDataDetail();
 }
\ No newline at end of file
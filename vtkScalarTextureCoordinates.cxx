@@ -0,0 +1,82 @@
+/*=========================================================================
+
+  Name:        vtkScalarTextureCoordinates.cxx
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+  Description: Adds texture coordinates that normalize the point scalars
+               to the color map range, clamping values outside it, so the
+               scalars can be colored with a 1D color map texture.
+
+=========================================================================*/
+
+
+#include "vtkScalarTextureCoordinates.h"
+
+#include <vtkCellData.h>
+#include <vtkDataSet.h>
+#include <vtkFloatArray.h>
+#include <vtkInformation.h>
+#include <vtkInformationVector.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+
+vtkCxxRevisionMacro(vtkScalarTextureCoordinates, "$Revision: 1.0 $");
+vtkStandardNewMacro(vtkScalarTextureCoordinates);
+
+vtkScalarTextureCoordinates::vtkScalarTextureCoordinates() {
+    Range[0] = 0.0;
+    Range[1] = 1.0;
+}
+
+vtkScalarTextureCoordinates::~vtkScalarTextureCoordinates() {
+}
+
+int vtkScalarTextureCoordinates::RequestData(vtkInformation* vtkNotUsed(request),
+                                             vtkInformationVector** inputVector,
+                                             vtkInformationVector* outputVector) {
+    vtkInformation* inInfo = inputVector[0]->GetInformationObject(0);
+    vtkInformation* outInfo = outputVector->GetInformationObject(0);
+
+    vtkDataSet* input = vtkDataSet::SafeDownCast(inInfo->Get(vtkDataObject::DATA_OBJECT()));
+    vtkDataSet* output = vtkDataSet::SafeDownCast(outInfo->Get(vtkDataObject::DATA_OBJECT()));
+
+    // Geometry and attributes are shared
+    output->CopyStructure(input);
+    output->GetPointData()->PassData(input->GetPointData());
+    output->GetCellData()->PassData(input->GetCellData());
+
+    vtkDataArray* scalars = input->GetPointData()->GetScalars();
+    if (!scalars) return 1;
+
+    double scale = Range[1] > Range[0] ? 1.0 / (Range[1] - Range[0]) : 0.0;
+
+    // Two components, as not all mappers handle 1D texture coordinates
+    vtkIdType numPoints = scalars->GetNumberOfTuples();
+
+    vtkFloatArray* tcoords = vtkFloatArray::New();
+    tcoords->SetName("ColorMapCoordinates");
+    tcoords->SetNumberOfComponents(2);
+    tcoords->SetNumberOfTuples(numPoints);
+    float* t = tcoords->GetPointer(0);
+
+    for (vtkIdType i = 0; i < numPoints; i++) {
+        double s = (scalars->GetTuple1(i) - Range[0]) * scale;
+
+        *t++ = (float)(s < 0.0 ? 0.0 : s > 1.0 ? 1.0 : s);
+        *t++ = 0.5f;
+    }
+
+    output->GetPointData()->SetTCoords(tcoords);
+    tcoords->Delete();
+
+    return 1;
+}
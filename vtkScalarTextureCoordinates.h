@@ -0,0 +1,52 @@
+/*=========================================================================
+
+  Name:        vtkScalarTextureCoordinates.h
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+  Description: Adds texture coordinates that normalize the point scalars
+               to the color map range, clamping values outside it, so the
+               scalars can be colored with a 1D color map texture.
+
+=========================================================================*/
+
+
+#ifndef __vtkScalarTextureCoordinates_h
+#define __vtkScalarTextureCoordinates_h
+
+#include <vtkDataSetAlgorithm.h>
+
+class vtkScalarTextureCoordinates : public vtkDataSetAlgorithm {
+public:
+    static vtkScalarTextureCoordinates* New();
+    vtkTypeRevisionMacro(vtkScalarTextureCoordinates, vtkDataSetAlgorithm);
+
+    // Scalar range mapped to texture coordinates 0 to 1.  Values outside
+    // the range are clamped.
+    vtkSetVector2Macro(Range, double);
+    vtkGetVector2Macro(Range, double);
+
+protected:
+    vtkScalarTextureCoordinates();
+    ~vtkScalarTextureCoordinates();
+
+    virtual int RequestData(vtkInformation* request,
+                            vtkInformationVector** inputVector,
+                            vtkInformationVector* outputVector);
+
+    double Range[2];
+
+private:
+    vtkScalarTextureCoordinates(const vtkScalarTextureCoordinates&);  // Not implemented.
+    void operator=(const vtkScalarTextureCoordinates&);  // Not implemented.
+};
+
+#endif
@@ -0,0 +1,86 @@
+/*=========================================================================
+
+  Name:        vtkScaleExtrusion.cxx
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+  Description: Rescales the output of vtkLinearExtrusionFilter by moving
+               the extruded points, sharing the cells and attributes with
+               the input, so the extrusion only needs to be done once.
+
+=========================================================================*/
+
+
+#include "vtkScaleExtrusion.h"
+
+#include <vtkInformation.h>
+#include <vtkInformationVector.h>
+#include <vtkObjectFactory.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+
+vtkCxxRevisionMacro(vtkScaleExtrusion, "$Revision: 1.0 $");
+vtkStandardNewMacro(vtkScaleExtrusion);
+
+vtkScaleExtrusion::vtkScaleExtrusion() {
+    ScaleFactor = 1.0;
+}
+
+vtkScaleExtrusion::~vtkScaleExtrusion() {
+}
+
+int vtkScaleExtrusion::RequestData(vtkInformation* vtkNotUsed(request),
+                                   vtkInformationVector** inputVector,
+                                   vtkInformationVector* outputVector) {
+    vtkInformation* inInfo = inputVector[0]->GetInformationObject(0);
+    vtkInformation* outInfo = outputVector->GetInformationObject(0);
+
+    vtkPolyData* input = vtkPolyData::SafeDownCast(inInfo->Get(vtkDataObject::DATA_OBJECT()));
+    vtkPolyData* output = vtkPolyData::SafeDownCast(outInfo->Get(vtkDataObject::DATA_OBJECT()));
+
+    // Cells and attributes are shared
+    output->ShallowCopy(input);
+
+    vtkPoints* inPoints = input->GetPoints();
+    if (!inPoints || ScaleFactor == 1.0) return 1;
+
+    // vtkLinearExtrusionFilter puts the input points first, then the
+    // extruded copy of each in the same order
+    vtkIdType numPoints = inPoints->GetNumberOfPoints();
+    if (numPoints % 2 != 0) {
+        vtkWarningMacro("Input is not the output of an extrusion");
+        return 1;
+    }
+    numPoints /= 2;
+
+    vtkPoints* points = vtkPoints::New();
+    points->SetDataType(inPoints->GetDataType());
+    points->SetNumberOfPoints(numPoints * 2);
+
+    for (vtkIdType i = 0; i < numPoints; i++) {
+        double p0[3];
+        double p1[3];
+        inPoints->GetPoint(i, p0);
+        inPoints->GetPoint(i + numPoints, p1);
+
+        for (int j = 0; j < 3; j++) {
+            p1[j] = p0[j] + (p1[j] - p0[j]) * ScaleFactor;
+        }
+
+        points->SetPoint(i, p0);
+        points->SetPoint(i + numPoints, p1);
+    }
+
+    output->SetPoints(points);
+    points->Delete();
+
+    return 1;
+}
@@ -0,0 +1,51 @@
+/*=========================================================================
+
+  Name:        vtkScaleExtrusion.h
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+  Description: Rescales the output of vtkLinearExtrusionFilter by moving
+               the extruded points, sharing the cells and attributes with
+               the input, so the extrusion only needs to be done once.
+
+=========================================================================*/
+
+
+#ifndef __vtkScaleExtrusion_h
+#define __vtkScaleExtrusion_h
+
+#include <vtkPolyDataAlgorithm.h>
+
+class vtkScaleExtrusion : public vtkPolyDataAlgorithm {
+public:
+    static vtkScaleExtrusion* New();
+    vtkTypeRevisionMacro(vtkScaleExtrusion, vtkPolyDataAlgorithm);
+
+    // Scale relative to the input extrusion
+    vtkSetMacro(ScaleFactor, double);
+    vtkGetMacro(ScaleFactor, double);
+
+protected:
+    vtkScaleExtrusion();
+    ~vtkScaleExtrusion();
+
+    virtual int RequestData(vtkInformation* request,
+                            vtkInformationVector** inputVector,
+                            vtkInformationVector* outputVector);
+
+    double ScaleFactor;
+
+private:
+    vtkScaleExtrusion(const vtkScaleExtrusion&);  // Not implemented.
+    void operator=(const vtkScaleExtrusion&);  // Not implemented.
+};
+
+#endif
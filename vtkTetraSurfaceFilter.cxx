@@ -0,0 +1,373 @@
+/*=========================================================================
+
+  Name:        vtkTetraSurfaceFilter.cxx
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+  Description: Extracts the boundary surface of an unstructured grid of
+               tetrahedra and triangles in parallel, keeping only the
+               points used by the surface.  Other cell types are passed
+               to vtkDataSetSurfaceFilter.
+
+=========================================================================*/
+
+
+#include "vtkTetraSurfaceFilter.h"
+
+#include "SimplexReader.h"
+
+#include <vtkCellArray.h>
+#include <vtkCellData.h>
+#include <vtkCellType.h>
+#include <vtkDataSetSurfaceFilter.h>
+#include <vtkIdTypeArray.h>
+#include <vtkInformation.h>
+#include <vtkInformationVector.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkUnstructuredGrid.h>
+
+#include <algorithm>
+
+vtkCxxRevisionMacro(vtkTetraSurfaceFilter, "$Revision: 1.0 $");
+vtkStandardNewMacro(vtkTetraSurfaceFilter);
+
+
+// Faces of a tetrahedron, ordered so the normals point out, as in vtkTetra
+static const int tetraFaces[4][3] = { { 0, 1, 3 }, { 1, 2, 3 }, { 2, 0, 3 }, { 0, 2, 1 } };
+
+enum {
+    CountPhase,
+    BucketPhase,
+    BoundaryPhase
+};
+
+
+vtkTetraSurfaceFilter::vtkTetraSurfaceFilter() {
+    Input = NULL;
+    Phase = CountPhase;
+    NumberOfBuckets = 1;
+}
+
+vtkTetraSurfaceFilter::~vtkTetraSurfaceFilter() {
+}
+
+
+int vtkTetraSurfaceFilter::FillInputPortInformation(int vtkNotUsed(port), vtkInformation* info) {
+    info->Set(vtkAlgorithm::INPUT_REQUIRED_DATA_TYPE(), "vtkUnstructuredGrid");
+    return 1;
+}
+
+
+int vtkTetraSurfaceFilter::RequestData(vtkInformation* vtkNotUsed(request),
+                                       vtkInformationVector** inputVector,
+                                       vtkInformationVector* outputVector) {
+    vtkInformation* inInfo = inputVector[0]->GetInformationObject(0);
+    vtkInformation* outInfo = outputVector->GetInformationObject(0);
+
+    vtkUnstructuredGrid* input = vtkUnstructuredGrid::SafeDownCast(inInfo->Get(vtkDataObject::DATA_OBJECT()));
+    vtkPolyData* output = vtkPolyData::SafeDownCast(outInfo->Get(vtkDataObject::DATA_OBJECT()));
+
+    vtkIdType numCells = input->GetNumberOfCells();
+    if (numCells == 0 || input->GetPoints() == NULL) return 1;
+
+    Input = input;
+
+    // Make the data safe to read from multiple threads
+    SimplexReader::Prepare(input);
+
+    vtkMultiThreader* threader = vtkMultiThreader::New();
+    int numThreads = threader->GetNumberOfThreads();
+    numThreads = numCells < numThreads ? (int)numCells : numThreads;
+    threader->SetNumberOfThreads(numThreads);
+    threader->SetSingleMethod(ThreadFunction, this);
+
+    NumberOfBuckets = numThreads;
+    BucketCounts.assign(numThreads, std::vector<vtkIdType>(NumberOfBuckets, 0));
+    Triangles.assign(numThreads, std::vector<vtkIdType>());
+    BoundaryFaces.assign(NumberOfBuckets, std::vector<vtkIdType>());
+    OtherCells.assign(numThreads, 0);
+
+    // Count faces per thread and bucket, and check cell types
+    Phase = CountPhase;
+    threader->SingleMethodExecute();
+
+    bool other = false;
+    for (int i = 0; i < numThreads; i++) {
+        other = other || OtherCells[i] != 0;
+    }
+
+    if (other) {
+        threader->Delete();
+
+        BucketCounts.clear();
+        Triangles.clear();
+        BoundaryFaces.clear();
+        OtherCells.clear();
+        Input = NULL;
+
+        // Copy the input so the internal filter doesn't change its pipeline connections
+        vtkUnstructuredGrid* copy = vtkUnstructuredGrid::New();
+        copy->ShallowCopy(input);
+
+        vtkDataSetSurfaceFilter* surface = vtkDataSetSurfaceFilter::New();
+        surface->SetInput(copy);
+        surface->Update();
+
+        output->ShallowCopy(surface->GetOutput());
+
+        surface->Delete();
+        copy->Delete();
+
+        return 1;
+    }
+
+    // Offsets for each thread within each bucket
+    vtkIdType numFaces = 0;
+    BucketStart.resize(NumberOfBuckets + 1);
+    for (int b = 0; b < NumberOfBuckets; b++) {
+        BucketStart[b] = numFaces;
+
+        for (int t = 0; t < numThreads; t++) {
+            vtkIdType count = BucketCounts[t][b];
+            BucketCounts[t][b] = numFaces;
+            numFaces += count;
+        }
+    }
+    BucketStart[NumberOfBuckets] = numFaces;
+
+    Faces.resize(numFaces);
+
+    // Write faces to buckets
+    Phase = BucketPhase;
+    threader->SingleMethodExecute();
+
+    // Sort each bucket to find faces used once
+    Phase = BoundaryPhase;
+    threader->SingleMethodExecute();
+
+    threader->Delete();
+
+    Faces.clear();
+    BucketCounts.clear();
+    BucketStart.clear();
+
+    // Number the points used by the surface
+    vtkIdType numInputPoints = input->GetNumberOfPoints();
+    std::vector<vtkIdType> pointMap(numInputPoints, -1);
+    std::vector<vtkIdType> usedPoints;
+
+    vtkIdType numPolys = 0;
+    for (int i = 0; i < numThreads; i++) numPolys += Triangles[i].size();
+    for (int i = 0; i < NumberOfBuckets; i++) numPolys += BoundaryFaces[i].size();
+
+    vtkIdTypeArray* connectivity = vtkIdTypeArray::New();
+    connectivity->SetNumberOfValues(numPolys * 4);
+    vtkIdType* c = connectivity->GetPointer(0);
+
+    vtkCellData* inCD = input->GetCellData();
+    vtkCellData* outCD = output->GetCellData();
+    outCD->CopyAllocate(inCD, numPolys);
+
+    vtkIdType polyId = 0;
+    for (int pass = 0; pass < 2; pass++) {
+        int numLists = pass == 0 ? numThreads : NumberOfBuckets;
+
+        for (int i = 0; i < numLists; i++) {
+            std::vector<vtkIdType>& list = pass == 0 ? Triangles[i] : BoundaryFaces[i];
+
+            for (int j = 0; j < (int)list.size(); j++) {
+                vtkIdType pts[3];
+                vtkIdType cellId;
+
+                if (pass == 0) {
+                    cellId = list[j];
+
+                    vtkIdType npts;
+                    vtkIdType* cellPts;
+                    input->GetCellPoints(cellId, npts, cellPts);
+                    pts[0] = cellPts[0];
+                    pts[1] = cellPts[1];
+                    pts[2] = cellPts[2];
+                }
+                else {
+                    cellId = list[j] / 4;
+                    GetFace(cellId, (int)(list[j] % 4), pts);
+                }
+
+                *c++ = 3;
+                for (int k = 0; k < 3; k++) {
+                    if (pointMap[pts[k]] < 0) {
+                        pointMap[pts[k]] = usedPoints.size();
+                        usedPoints.push_back(pts[k]);
+                    }
+                    *c++ = pointMap[pts[k]];
+                }
+
+                outCD->CopyData(inCD, cellId, polyId++);
+            }
+        }
+    }
+
+    Triangles.clear();
+    BoundaryFaces.clear();
+    Input = NULL;
+
+    // Copy the used points and their data
+    vtkIdType numPoints = usedPoints.size();
+
+    vtkPoints* inPoints = input->GetPoints();
+    vtkPoints* points = vtkPoints::New();
+    points->SetDataType(inPoints->GetDataType());
+    points->SetNumberOfPoints(numPoints);
+
+    vtkPointData* inPD = input->GetPointData();
+    vtkPointData* outPD = output->GetPointData();
+    outPD->CopyAllocate(inPD, numPoints);
+
+    for (vtkIdType i = 0; i < numPoints; i++) {
+        points->SetPoint(i, inPoints->GetPoint(usedPoints[i]));
+        outPD->CopyData(inPD, usedPoints[i], i);
+    }
+
+    vtkCellArray* polys = vtkCellArray::New();
+    polys->SetCells(numPolys, connectivity);
+
+    output->SetPoints(points);
+    output->SetPolys(polys);
+
+    points->Delete();
+    polys->Delete();
+    connectivity->Delete();
+
+    return 1;
+}
+
+
+VTK_THREAD_RETURN_TYPE vtkTetraSurfaceFilter::ThreadFunction(void* arg) {
+    vtkMultiThreader::ThreadInfo* info = static_cast<vtkMultiThreader::ThreadInfo*>(arg);
+    vtkTetraSurfaceFilter* self = static_cast<vtkTetraSurfaceFilter*>(info->UserData);
+
+    self->ThreadExecute(info->ThreadID, info->NumberOfThreads);
+
+    return VTK_THREAD_RETURN_VALUE;
+}
+
+void vtkTetraSurfaceFilter::ThreadExecute(int thread, int numThreads) {
+    switch (Phase) {
+        case CountPhase:
+            CountFaces(thread, numThreads);
+            break;
+
+        case BucketPhase:
+            BucketFaces(thread, numThreads);
+            break;
+
+        case BoundaryPhase:
+            for (int b = thread; b < NumberOfBuckets; b += numThreads) {
+                FindBoundaryFaces(b);
+            }
+            break;
+    }
+}
+
+
+void vtkTetraSurfaceFilter::CountFaces(int thread, int numThreads) {
+    std::vector<vtkIdType>& counts = BucketCounts[thread];
+
+    vtkIdType numCells = Input->GetNumberOfCells();
+    vtkIdType start = numCells * thread / numThreads;
+    vtkIdType end = numCells * (thread + 1) / numThreads;
+
+    for (vtkIdType cellId = start; cellId < end; cellId++) {
+        int type = Input->GetCellType(cellId);
+
+        if (type == VTK_TRIANGLE) {
+            // Always part of the surface
+            Triangles[thread].push_back(cellId);
+        }
+        else if (type == VTK_TETRA) {
+            for (int i = 0; i < 4; i++) {
+                Face f;
+                GetFace(cellId, i, f.key);
+                std::sort(f.key, f.key + 3);
+
+                counts[GetBucket(f.key)]++;
+            }
+        }
+        else {
+            OtherCells[thread] = 1;
+            return;
+        }
+    }
+}
+
+void vtkTetraSurfaceFilter::BucketFaces(int thread, int numThreads) {
+    // Next position for this thread in each bucket
+    std::vector<vtkIdType>& next = BucketCounts[thread];
+
+    vtkIdType numCells = Input->GetNumberOfCells();
+    vtkIdType start = numCells * thread / numThreads;
+    vtkIdType end = numCells * (thread + 1) / numThreads;
+
+    for (vtkIdType cellId = start; cellId < end; cellId++) {
+        if (Input->GetCellType(cellId) != VTK_TETRA) continue;
+
+        for (int i = 0; i < 4; i++) {
+            Face f;
+            GetFace(cellId, i, f.key);
+            std::sort(f.key, f.key + 3);
+            f.face = cellId * 4 + i;
+
+            Faces[next[GetBucket(f.key)]++] = f;
+        }
+    }
+}
+
+void vtkTetraSurfaceFilter::FindBoundaryFaces(int bucket) {
+    std::vector<vtkIdType>& boundary = BoundaryFaces[bucket];
+
+    Face* begin = &Faces[0] + BucketStart[bucket];
+    Face* end = &Faces[0] + BucketStart[bucket + 1];
+
+    std::sort(begin, end);
+
+    // Interior faces are shared by two tetrahedra
+    for (Face* f = begin; f < end; ) {
+        Face* g = f + 1;
+        while (g < end && g->key[0] == f->key[0] && g->key[1] == f->key[1] && g->key[2] == f->key[2]) g++;
+
+        if (g - f == 1) boundary.push_back(f->face);
+
+        f = g;
+    }
+}
+
+
+int vtkTetraSurfaceFilter::GetBucket(const vtkIdType key[3]) {
+    unsigned long h = (unsigned long)key[0] * 73856093UL ^
+                      (unsigned long)key[1] * 19349663UL ^
+                      (unsigned long)key[2] * 83492791UL;
+
+    return (int)(h % (unsigned long)NumberOfBuckets);
+}
+
+void vtkTetraSurfaceFilter::GetFace(vtkIdType cellId, int face, vtkIdType pts[3]) {
+    vtkIdType npts;
+    vtkIdType* cellPts;
+    Input->GetCellPoints(cellId, npts, cellPts);
+
+    pts[0] = cellPts[tetraFaces[face][0]];
+    pts[1] = cellPts[tetraFaces[face][1]];
+    pts[2] = cellPts[tetraFaces[face][2]];
+}
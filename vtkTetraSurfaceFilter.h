@@ -0,0 +1,93 @@
+/*=========================================================================
+
+  Name:        vtkTetraSurfaceFilter.h
+
+  Author:      David Borland, The Renaissance Computing Institute (RENCI)
+
+  Copyright:   The Renaissance Computing Institute (RENCI)
+
+  License:     Licensed under the RENCI Open Source Software License v. 1.0
+
+               See included License.txt or
+               http://www.renci.org/resources/open-source-software-license
+               for details.
+
+  Description: Extracts the boundary surface of an unstructured grid of
+               tetrahedra and triangles in parallel, keeping only the
+               points used by the surface.  Other cell types are passed
+               to vtkDataSetSurfaceFilter.
+
+=========================================================================*/
+
+
+#ifndef __vtkTetraSurfaceFilter_h
+#define __vtkTetraSurfaceFilter_h
+
+#include <vtkPolyDataAlgorithm.h>
+#include <vtkMultiThreader.h>
+
+#include <vector>
+
+class vtkUnstructuredGrid;
+
+class vtkTetraSurfaceFilter : public vtkPolyDataAlgorithm {
+public:
+    static vtkTetraSurfaceFilter* New();
+    vtkTypeRevisionMacro(vtkTetraSurfaceFilter, vtkPolyDataAlgorithm);
+
+protected:
+    vtkTetraSurfaceFilter();
+    ~vtkTetraSurfaceFilter();
+
+    virtual int FillInputPortInformation(int port, vtkInformation* info);
+    virtual int RequestData(vtkInformation* request,
+                            vtkInformationVector** inputVector,
+                            vtkInformationVector* outputVector);
+
+    // A tetrahedron face, with its sorted point ids as the key, and the
+    // cell id * 4 + face index to recover the outward orientation
+    struct Face {
+        vtkIdType key[3];
+        vtkIdType face;
+
+        bool operator<(const Face& other) const {
+            if (key[0] != other.key[0]) return key[0] < other.key[0];
+            if (key[1] != other.key[1]) return key[1] < other.key[1];
+            if (key[2] != other.key[2]) return key[2] < other.key[2];
+            return face < other.face;
+        }
+    };
+
+    // Faces are bucketed by a hash of their key, one bucket per thread.
+    // Each thread counts its faces per bucket, then writes them at its own
+    // offset, so each bucket is contiguous and no locking is needed.
+    // Each bucket is then sorted, and faces that occur once are boundary faces.
+    vtkUnstructuredGrid* Input;
+    int Phase;
+    int NumberOfBuckets;
+    std::vector<Face> Faces;
+    std::vector< std::vector<vtkIdType> > BucketCounts;
+    std::vector<vtkIdType> BucketStart;
+    std::vector< std::vector<vtkIdType> > Triangles;
+    std::vector< std::vector<vtkIdType> > BoundaryFaces;
+
+    // Set by each thread that finds other cell types.  Not vector<bool>,
+    // as the threads write their flags at the same time.
+    std::vector<char> OtherCells;
+
+    static VTK_THREAD_RETURN_TYPE ThreadFunction(void* arg);
+    void ThreadExecute(int thread, int numThreads);
+
+    void CountFaces(int thread, int numThreads);
+    void BucketFaces(int thread, int numThreads);
+    void FindBoundaryFaces(int bucket);
+
+    int GetBucket(const vtkIdType key[3]);
+    void GetFace(vtkIdType cellId, int face, vtkIdType pts[3]);
+
+private:
+    vtkTetraSurfaceFilter(const vtkTetraSurfaceFilter&);  // Not implemented.
+    void operator=(const vtkTetraSurfaceFilter&);  // Not implemented.
+};
+
+#endif